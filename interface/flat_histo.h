@@ -0,0 +1,58 @@
+#ifndef FLATHISTO_H
+#define FLATHISTO_H
+
+/** \file flat_histo.h
+\brief A minimal histogram for the fills in the event loop.
+
+`TH1D::Fill` is a virtual call that searches the bin through `TAxis` and updates the ROOT bookkeeping at every fill.
+The flat histogram keeps plain arrays of the sums of weights, the bin is found without `TAxis`:
+the linear bins are calculated as in `TAxis::FindFixBin`,
+the custom bins are looked up in a uniform grid of cells not wider than the narrowest bin.
+The sums are added to the output `TH1D` once, at the end of the event loop.
+
+The binning is kept apart from the sums, all histograms of a distribution share one binning.
+ */
+
+#include "TH1D.h"
+
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+/** \brief The binning of a `TH1D`, with the underflow `0` and the overflow `nbins+1` bins.
+ */
+
+typedef struct {
+	unsigned int nbins;
+	bool   linear;
+	double xmin, xmax;
+	vector<double> edges;  /**< \brief the `nbins+1` edges of the custom bins */
+	double inv_cell_width;             /**< \brief the reciprocal of the width of the lookup cells of the custom bins */
+	vector<unsigned int> bin_of_cell;  /**< \brief the bin at the lower side of each cell, empty if the grid is too fine */
+} S_flat_binning;
+
+/** \brief The sums of weights per bin and the fill statistics, as in `TH1::GetStats`.
+
+The sums are empty until the histogram is created with its binning.
+ */
+
+typedef struct {
+	vector<double> sumw;   /**< \brief per bin, including the underflow and the overflow */
+	vector<double> sumw2;
+	double tsumw, tsumw2, tsumwx, tsumwx2;
+	Long64_t n_fills;
+} S_flat_histo;
+
+S_flat_binning create_flat_binning(TH1D* histo);
+S_flat_histo   create_flat_histo(const S_flat_binning& binning);
+void flat_histo_flush(S_flat_histo& flat, TH1D* histo);
+unsigned int flat_binning_find_bin(const S_flat_binning& binning, double value);
+void flat_histo_fill(S_flat_histo& flat, const S_flat_binning& binning, double value, double weight);
+void TH1D_add_sums(TH1D* histo, const double* sumw, const double* sumw2, unsigned int stride, const double* stats, Long64_t n_fills);
+
+/** \brief The upper limit on the number of lookup cells of the custom bins, above it the bins are found by a binary search. */
+#define MAX_FLAT_BINNING_CELLS 4096
+
+#endif /* FLATHISTO_H */
+
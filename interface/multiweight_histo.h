@@ -0,0 +1,43 @@
+#ifndef MULTIWEIGHTHISTO_H
+#define MULTIWEIGHTHISTO_H
+
+/** \file multiweight_histo.h
+\brief A histogram of a group of weight variations of the same distribution.
+
+The weight systematics of one object systematic record the same value with different event weights,
+e.g. the 56 `PDFCT14n*Up` variations.
+A separate `TH1D::Fill` for each variation repeats the same bin search.
+The multi-weight histogram keeps a contiguous `[bin][variation]` matrix of the sums of weights:
+the bin is found once per fill, and the weights of all variations are accumulated in a plain loop over the matrix row.
+At the end the matrix is expanded into the usual `TH1D`s of the variations.
+ */
+
+#include "TH1D.h"
+
+#include "UserCode/proc/interface/flat_histo.h"
+
+#include <vector>
+
+using namespace std;
+
+/** \brief The `[bin][variation]` sums of weights and the per-variation fill statistics.
+
+The bins include the underflow and the overflow, as in `TH1D`.
+The statistics are the same as in `TH1::GetStats`: sum of weights, weights squared, weight*x and weight*x^2,
+they are kept per variation to make the fill loop contiguous.
+ */
+
+typedef struct {
+	unsigned int n_variations;
+	unsigned int n_bins;    /**< \brief including the underflow and the overflow */
+	vector<double> sumw;    /**< \brief `[bin][variation]` */
+	vector<double> sumw2;   /**< \brief `[bin][variation]` */
+	vector<double> tsumw, tsumw2, tsumwx, tsumwx2; /**< \brief `[variation]` */
+	Long64_t n_fills;
+} S_multiweight_histo;
+
+S_multiweight_histo create_multiweight_histo(const S_flat_binning& binning, unsigned int n_variations);
+void multiweight_histo_fill(S_multiweight_histo& mw, const S_flat_binning& binning, double value, double weight, const double* variation_factors);
+void multiweight_histo_expand(S_multiweight_histo& mw, const vector<TH1D*>& variation_histos);
+
+#endif /* MULTIWEIGHTHISTO_H */
@@ -75,9 +75,16 @@
  */
 
 #if defined(NTUPLE_INTERFACE_DECLARE_STATIC) // to use in C libs etc
-#    define DECLARE_PREFIX static
+#    define DECLARE_STATIC_PREFIX static
 #else
-#    define DECLARE_PREFIX
+#    define DECLARE_STATIC_PREFIX
+#endif
+
+// each thread of a multi-threaded loop connects its own TTree to its own copy of the buffers
+#if defined(NTUPLE_INTERFACE_DECLARE_THREAD_LOCAL)
+#    define DECLARE_PREFIX DECLARE_STATIC_PREFIX thread_local
+#else
+#    define DECLARE_PREFIX DECLARE_STATIC_PREFIX
 #endif
 
 #if defined(NTUPLE_INTERFACE_CLASS_DECLARE) // ALSO: in EDM Classes NTuple is pointer to TFile Service!
@@ -735,4 +742,5 @@ OBJECT_in_NTuple(OUTNTUPLE, PV_cov, ROOT::Math::SMatrix<double, 3, 3, ROOT::Math
 #undef Bool_t_in_NTuple
 
 #undef DECLARE_PREFIX
+#undef DECLARE_STATIC_PREFIX
 
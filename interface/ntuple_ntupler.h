@@ -15,6 +15,7 @@ T_known_defs_procs    create_known_defs_procs_ntupler(void);
 T_known_defs_distrs   create_known_defs_distrs_ntupler(void);
 T_known_defs_channels create_known_defs_channels_ntupler(void);
 T_known_defs_systs    create_known_defs_systs_ntupler(void);
+_S_base_weight_definition create_base_weight_definition_ntupler(void);
 
 T_known_MC_normalization_per_somename create_known_MC_normalization_per_syst_ntupler(void);
 T_known_MC_normalization_per_somename create_known_MC_normalization_per_proc_ntupler(void);
@@ -15,6 +15,7 @@ T_known_defs_procs    create_known_defs_procs_stage2(void);
 T_known_defs_distrs   create_known_defs_distrs_stage2(void);
 T_known_defs_channels create_known_defs_channels_stage2(void);
 T_known_defs_systs    create_known_defs_systs_stage2(void);
+_S_base_weight_definition create_base_weight_definition_stage2(void);
 
 T_known_MC_normalization_per_somename create_known_MC_normalization_per_syst_stage2(void);
 T_known_MC_normalization_per_somename create_known_MC_normalization_per_proc_stage2(void);
@@ -41,6 +41,7 @@ the same gen-level process is defined differently in original ntuples and in sta
 
 #include <map>
 #include <vector>
+#include <initializer_list>
 
 using namespace std;
 
@@ -90,8 +91,75 @@ enum ObjSystematics {NOMINAL /**< NOMINAL sysytematic corrections, event weights
  TESDown /**< tau energy scale Down corrections are applied to taus */
 };
 
+/** \brief The number of `ObjSystematics`, to size the per-systematic arrays. */
+#define N_OBJ_SYSTEMATICS (TESDown + 1)
+
 typedef double (*_F_sysweight)();
 
+/** \brief Define a memoized `calc_func(ObjSystematics)` from the function `_calc_func`.
+
+The result is kept per object systematic, it is valid for the current entry of the connected TTree.
+The translation unit of the ntuple interface defines the `thread_local` state of the memoization:
+`TTree* NT_memo_ttree`, set when the interface is connected,
+and `unsigned long NT_memo_generation`, incremented at each connection,
+which distinguishes the same entry number in different input files.
+ */
+
+#define NT_calc_memoized(T_ret, calc_func)                                  \
+static T_ret calc_func(ObjSystematics sys)                                 \
+	{                                                                  \
+	static thread_local unsigned long memo_generation[N_OBJ_SYSTEMATICS]; \
+	static thread_local Long64_t      memo_entry     [N_OBJ_SYSTEMATICS]; \
+	static thread_local T_ret         memo_value     [N_OBJ_SYSTEMATICS]; \
+	if (!NT_memo_ttree) return _ ## calc_func(sys);                    \
+	Long64_t entry = NT_memo_ttree->GetReadEntry();                    \
+	if (memo_generation[sys] != NT_memo_generation || memo_entry[sys] != entry) \
+		{                                                          \
+		memo_value[sys]      = _ ## calc_func(sys);                \
+		memo_entry[sys]      = entry;                              \
+		memo_generation[sys] = NT_memo_generation;                 \
+		}                                                          \
+	return memo_value[sys];                                            \
+	}
+
+/** \brief A distribution function specialized for one object systematic.
+ */
+
+typedef double (*_F_distr_at_sys)(void);
+
+/** \brief Instantiate the template `_name<ObjSystematics>` for each object systematic.
+
+Defines the table `name_per_sys[N_OBJ_SYSTEMATICS]` of the instances,
+which the distribution definition passes in `func_per_sys`,
+and the runtime function `name(ObjSystematics)` calling the instance of the given systematic.
+In an instance the systematic is a constant, the choice of the variables by the systematic is resolved at compile time.
+ */
+
+#define NT_distr_per_obj_sys(name)                                         \
+static const _F_distr_at_sys name ## _per_sys[N_OBJ_SYSTEMATICS] = {       \
+	_ ## name<NOMINAL>,                                                \
+	_ ## name<JERUp>, _ ## name<JERDown>,                              \
+	_ ## name<JESUp>, _ ## name<JESDown>,                              \
+	_ ## name<TESUp>, _ ## name<TESDown>};                             \
+static double name(ObjSystematics sys) {return name ## _per_sys[sys]();}
+
+
+/** \brief The names of the input `TTree` branches that a definition reads.
+
+The definitions of channels, processes, systematics and distributions declare the branches they read,
+and `sumup_loop` activates only the union of the branches of the requested definitions.
+
+A `%s` in a name stands for the suffix of the object systematic: `selection_stage%s` is `selection_stage_JERUp` for `JERUp`,
+and `selection_stage` for `NOMINAL`.
+The name `*` means that the definition may read any branch.
+It is the default for the definitions that do not declare their branches, then all branches are read.
+ */
+
+typedef vector<TString> T_branches;
+
+T_branches branches_join(std::initializer_list<T_branches> lists);
+T_branches branches_in_expression(const char* expression);
+
 
 /* the objects that define event records:
 
@@ -123,6 +191,7 @@ typedef bool (*_F_channel_sel)(ObjSystematics);
 typedef struct {
 	_F_channel_sel chan_sel;        /**< \brief the event selection function */
 	_F_sysweight   chan_sel_weight; /**< \brief the nominal event weight */
+	T_branches     branches = {"*"}; /**< \brief the branches read by the selection and the weight */
 } _S_chan_def;
 
 
@@ -138,9 +207,17 @@ typedef map<TString, _S_chan_def> T_known_defs_channels;
 
 typedef bool (*_F_genproc_def)(void);
 
+/** \brief The function calculating the gen process ID of the event.
+ */
+
+typedef int (*_F_gen_proc_id)(void);
+
 /** \brief The definition of (sub-)processes for a given dtag
 
 Contains gen ID ranges for all possible sub-processes and the handy groups.
+
+If the `gen_proc_id` function is given, the process definitions must be functions of the ID only:
+then `sumup_loop` calculates the ID once per event, and keeps the process of each ID found in a channel.
  */
 
 typedef struct {
@@ -148,13 +225,15 @@ typedef struct {
 	map<TString, _F_genproc_def> all;    /**< \brief all possible sub-processes */
 	map<TString, _F_genproc_def> groups; /**< \brief groups of sub-processes */
 	map<TString, vector<TString>> channel_standard; /**< \brief standard sub-processes per channel */
+	T_branches branches = {"*"};         /**< \brief the gen-level branches read by the process definitions */
+	_F_gen_proc_id gen_proc_id = NULL;  /**< \brief the gen process ID, NULL if the processes are not defined by an ID */
 } _S_proc_ID_defs;
 
 
 
 // ----- systematic
 
-typedef struct {ObjSystematics obj_sys_id; _F_sysweight weight_func;} _S_systematic_definition;
+typedef struct {ObjSystematics obj_sys_id; _F_sysweight weight_func; T_branches branches = {"*"};} _S_systematic_definition;
 
 /**
 \ingroup NtupleInterface
@@ -163,6 +242,14 @@ typedef struct {ObjSystematics obj_sys_id; _F_sysweight weight_func;} _S_systema
 
 typedef map<TString, _S_systematic_definition> T_known_defs_systs; // used in sumup_loop main
 
+/** \brief The MC event weight before the channel selections and the calibrations, the reference of the sums of the systematic weights.
+
+`gen_weight_func` is the generator weight, with its sign.
+`base_weight_func` is the generator weight times the nominal pile-up weight, the systematic weight factors multiply it.
+ */
+
+typedef struct {_F_sysweight gen_weight_func; _F_sysweight base_weight_func; T_branches branches = {"*"};} _S_base_weight_definition;
+
 // ----- distribution
 
 /** \brief The definition of TH1D ranges, linear and custom.
@@ -190,6 +277,8 @@ typedef struct {
 typedef struct {
 	double (*func)(ObjSystematics);
 	_TH1D_histo_range range;
+	T_branches branches = {"*"}; /**< \brief the branches read by the function */
+	const _F_distr_at_sys* func_per_sys = NULL; /**< \brief the instances of the function per object systematic, NULL if not specialized */
 } _TH1D_histo_def;
 
 /**
@@ -0,0 +1,161 @@
+
+#include "UserCode/proc/interface/flat_histo.h"
+
+#include <math.h> // ceil
+
+/** \brief Copy the binning of the `TH1D`, and set up the lookup cells of the custom bins.
+
+\param  TH1D* histo
+\return S_flat_binning
+ */
+
+S_flat_binning create_flat_binning(TH1D* histo)
+	{
+	TAxis* axis = histo->GetXaxis();
+
+	S_flat_binning binning;
+	binning.nbins = axis->GetNbins();
+	binning.xmin  = axis->GetXmin();
+	binning.xmax  = axis->GetXmax();
+
+	const TArrayD* custom_edges = axis->GetXbins();
+	binning.linear = custom_edges->GetSize() == 0;
+	binning.inv_cell_width = 0.;
+	if (binning.linear) return binning;
+
+	for (int i=0; i<custom_edges->GetSize(); i++)
+		binning.edges.push_back((*custom_edges)[i]);
+
+	// the cells are not wider than the narrowest bin
+	double min_width = binning.xmax - binning.xmin;
+	for (unsigned int bin=1; bin<=binning.nbins; bin++)
+		min_width = min(min_width, binning.edges[bin] - binning.edges[bin-1]);
+
+	if (min_width <= 0. || (binning.xmax - binning.xmin) / min_width > MAX_FLAT_BINNING_CELLS) return binning;
+	unsigned int n_cells = (unsigned int) ceil((binning.xmax - binning.xmin) / min_width);
+
+	double cell_width = (binning.xmax - binning.xmin) / n_cells;
+	binning.inv_cell_width = 1. / cell_width;
+	for (unsigned int cell=0; cell<n_cells; cell++)
+		{
+		double cell_low = binning.xmin + cell * cell_width;
+		unsigned int bin = upper_bound(binning.edges.begin(), binning.edges.end(), cell_low) - binning.edges.begin();
+		// inside the range
+		binning.bin_of_cell.push_back(bin < 1 ? 1 : (bin > binning.nbins ? binning.nbins : bin));
+		}
+
+	return binning;
+	}
+
+/** \brief The bin of the value, the same as `TAxis::FindFixBin`.
+
+The values below the range go to the underflow, the values above the range and the NaN go to the overflow.
+
+The linear bins are calculated with the same expression as in `TAxis::FindFixBin`, so that the values at the bin edges get the same bin.
+A lookup cell contains at most one bin edge,
+so the bin of its lower side is about one bin off, which is corrected by comparing with the edges of the bin.
+The same correction covers the rounding of the cell width and of the cell index at the cell boundaries.
+`test/test_flat_binning.cpp` compares the bins with `TAxis::FindFixBin` in the distributions of the interfaces.
+ */
+
+unsigned int flat_binning_find_bin(const S_flat_binning& binning, double value)
+	{
+	if (value < binning.xmin) return 0;
+	if (!(value < binning.xmax)) return binning.nbins + 1;
+
+	if (binning.linear)
+		// the rounding below xmax can give the overflow bin, as in ROOT
+		return 1 + (unsigned int) (binning.nbins * (value - binning.xmin) / (binning.xmax - binning.xmin));
+
+	if (binning.bin_of_cell.empty())
+		// the number of edges <= value
+		return upper_bound(binning.edges.begin(), binning.edges.end(), value) - binning.edges.begin();
+
+	unsigned int cell = (unsigned int) ((value - binning.xmin) * binning.inv_cell_width);
+	if (cell >= binning.bin_of_cell.size()) cell = binning.bin_of_cell.size() - 1;
+
+	// the bin covers [edges[bin-1], edges[bin])
+	unsigned int bin = binning.bin_of_cell[cell];
+	// the edges stop the corrections: edges[0] = xmin <= value < xmax = edges[nbins]
+	while (value >= binning.edges[bin])  bin++;
+	while (value <  binning.edges[bin-1]) bin--;
+	return bin;
+	}
+
+/** \brief Add the weighted value to the sums of its bin and to the fill statistics.
+ */
+
+void flat_histo_fill(S_flat_histo& flat, const S_flat_binning& binning, double value, double weight)
+	{
+	unsigned int bin = flat_binning_find_bin(binning, value);
+	flat.sumw [bin] += weight;
+	flat.sumw2[bin] += weight*weight;
+	flat.n_fills++;
+
+	// as TH1::Fill, the statistics do not include the underflow and the overflow
+	if (bin == 0 || bin == binning.nbins + 1) return;
+	flat.tsumw   += weight;
+	flat.tsumw2  += weight*weight;
+	flat.tsumwx  += weight*value;
+	flat.tsumwx2 += weight*value*value;
+	}
+
+/** \brief Create an empty flat histogram with the binning.
+
+\param  const S_flat_binning& binning
+\return S_flat_histo
+ */
+
+S_flat_histo create_flat_histo(const S_flat_binning& binning)
+	{
+	S_flat_histo flat;
+	flat.sumw .assign(binning.nbins + 2, 0.);
+	flat.sumw2.assign(binning.nbins + 2, 0.);
+	flat.tsumw = flat.tsumw2 = flat.tsumwx = flat.tsumwx2 = 0.;
+	flat.n_fills = 0;
+	return flat;
+	}
+
+/** \brief Add the sums of weights per bin and the statistics to the `TH1D`.
+
+The sums of the bin `bin` are `sumw[bin * stride]` and `sumw2[bin * stride]`,
+the `stats` are the sums of weights, weights squared, weight*x and weight*x^2, as in `TH1::GetStats`.
+ */
+
+void TH1D_add_sums(TH1D* histo, const double* sumw, const double* sumw2, unsigned int stride, const double* stats, Long64_t n_fills)
+	{
+	// the weighted fills switch on the errors per bin
+	if (histo->GetSumw2N() == 0)
+		histo->Sumw2();
+
+	double histo_stats[4];
+	histo->GetStats(histo_stats);
+
+	TArrayD* histo_sumw2 = histo->GetSumw2();
+	unsigned int n_bins = histo->GetNbinsX() + 2;
+	for (unsigned int bin=0; bin<n_bins; bin++)
+		{
+		histo->AddBinContent(bin, sumw[bin * stride]);
+		(*histo_sumw2)[bin] += sumw2[bin * stride];
+		}
+
+	for (int i=0; i<4; i++)
+		histo_stats[i] += stats[i];
+	histo->PutStats(histo_stats);
+	histo->SetEntries(histo->GetEntries() + n_fills);
+	}
+
+/** \brief Add the flat histogram to the `TH1D` with the same binning, and reset the flat histogram.
+ */
+
+void flat_histo_flush(S_flat_histo& flat, TH1D* histo)
+	{
+	double stats[4] = {flat.tsumw, flat.tsumw2, flat.tsumwx, flat.tsumwx2};
+	TH1D_add_sums(histo, flat.sumw.data(), flat.sumw2.data(), 1, stats, flat.n_fills);
+
+	flat.sumw .assign(flat.sumw.size(),  0.);
+	flat.sumw2.assign(flat.sumw2.size(), 0.);
+	flat.tsumw = flat.tsumw2 = flat.tsumwx = flat.tsumwx2 = 0.;
+	flat.n_fills = 0;
+	}
+
@@ -0,0 +1,88 @@
+
+#include "UserCode/proc/interface/multiweight_histo.h"
+
+/** \brief Create an empty multi-weight histogram with the binning.
+
+\param  const S_flat_binning& binning
+\param  unsigned int n_variations
+\return S_multiweight_histo
+ */
+
+S_multiweight_histo create_multiweight_histo(const S_flat_binning& binning, unsigned int n_variations)
+	{
+	S_multiweight_histo mw;
+	mw.n_variations = n_variations;
+	mw.n_bins       = binning.nbins + 2;
+
+	mw.sumw   .assign(mw.n_bins * n_variations, 0.);
+	mw.sumw2  .assign(mw.n_bins * n_variations, 0.);
+	mw.tsumw  .assign(n_variations, 0.);
+	mw.tsumw2 .assign(n_variations, 0.);
+	mw.tsumwx .assign(n_variations, 0.);
+	mw.tsumwx2.assign(n_variations, 0.);
+	mw.n_fills = 0;
+
+	return mw;
+	}
+
+/** \brief Fill the value in all variations, the weight of a variation is `weight * variation_factors[variation]`.
+
+The loops run over contiguous arrays of the length `n_variations`, so that the compiler vectorizes them.
+ */
+
+void multiweight_histo_fill(S_multiweight_histo& mw, const S_flat_binning& binning, double value, double weight, const double* variation_factors)
+	{
+	const unsigned int n_vars = mw.n_variations;
+	unsigned int bin = flat_binning_find_bin(binning, value);
+
+	double* __restrict__ sumw  = &mw.sumw [bin * n_vars];
+	double* __restrict__ sumw2 = &mw.sumw2[bin * n_vars];
+	for (unsigned int v=0; v<n_vars; v++)
+		{
+		double w = weight * variation_factors[v];
+		sumw [v] += w;
+		sumw2[v] += w*w;
+		}
+
+	mw.n_fills++;
+
+	// as TH1::Fill, the statistics do not include the underflow and the overflow
+	if (bin == 0 || bin == mw.n_bins - 1) return;
+
+	double* __restrict__ tsumw   = mw.tsumw  .data();
+	double* __restrict__ tsumw2  = mw.tsumw2 .data();
+	double* __restrict__ tsumwx  = mw.tsumwx .data();
+	double* __restrict__ tsumwx2 = mw.tsumwx2.data();
+	for (unsigned int v=0; v<n_vars; v++)
+		{
+		double w = weight * variation_factors[v];
+		tsumw  [v] += w;
+		tsumw2 [v] += w*w;
+		tsumwx [v] += w*value;
+		tsumwx2[v] += w*value*value;
+		}
+	}
+
+/** \brief Add the recorded variations to their `TH1D`s and reset the multi-weight histogram.
+
+The histograms must have the binning of the multi-weight histogram,
+`variation_histos[v]` receives the variation `v`.
+ */
+
+void multiweight_histo_expand(S_multiweight_histo& mw, const vector<TH1D*>& variation_histos)
+	{
+	for (unsigned int v=0; v<mw.n_variations; v++)
+		{
+		double stats[4] = {mw.tsumw[v], mw.tsumw2[v], mw.tsumwx[v], mw.tsumwx2[v]};
+		TH1D_add_sums(variation_histos[v], &mw.sumw[v], &mw.sumw2[v], mw.n_variations, stats, mw.n_fills);
+		}
+
+	mw.sumw   .assign(mw.sumw.size(),  0.);
+	mw.sumw2  .assign(mw.sumw2.size(), 0.);
+	mw.tsumw  .assign(mw.n_variations, 0.);
+	mw.tsumw2 .assign(mw.n_variations, 0.);
+	mw.tsumwx .assign(mw.n_variations, 0.);
+	mw.tsumwx2.assign(mw.n_variations, 0.);
+	mw.n_fills = 0;
+	}
+
@@ -2,13 +2,22 @@
 #include "UserCode/proc/interface/ntuple_ntupler.h"
 
 /* Global interface to the ttree, the name space for all the event-processing fucntions.
+ * Static to this file, and thread_local for the multi-threaded sumup_loop.
  */
 #define NTUPLE_INTERFACE_DECLARE_STATIC
+#define NTUPLE_INTERFACE_DECLARE_THREAD_LOCAL
 #define NTUPLE_INTERFACE_CLASS_DECLARE
 #include "ntupler_interface.h"
 #undef NTUPLE_INTERFACE_DECLARE_STATIC
+#undef NTUPLE_INTERFACE_DECLARE_THREAD_LOCAL
 #undef NTUPLE_INTERFACE_CLASS_DECLARE
 
+/* Per-event memoization of the NT_calc_* helpers, see NT_calc_memoized.
+ * The channel functions call the same selection calculations many times per event and systematic.
+ */
+static thread_local TTree*        NT_memo_ttree = NULL;
+static thread_local unsigned long NT_memo_generation = 0;
+
 /* --------------------------------------------------------------- */
 /* STD DEFS */
 //#include "std_defs.h"
@@ -24,11 +33,13 @@ static double NT_sysweight_NOMINAL_HLT_EL()
 	{
 	return 1.; // NT_event_weight*NT_event_weight_PU*NT_event_weight_LEPmuID*NT_event_weight_LEPelID* NT_event_weight_LEPelTRG;
 	}
+static T_branches NT_sysweight_NOMINAL_HLT_EL_branches = {};
 
 static double NT_sysweight_NOMINAL_HLT_MU()
 	{
 	return 1.; // NT_event_weight*NT_event_weight_PU*NT_event_weight_LEPmuID*NT_event_weight_LEPelID* NT_event_weight_LEPmuTRG;
 	}
+static T_branches NT_sysweight_NOMINAL_HLT_MU_branches = {};
 
 static double NT_sysweight_NOMINAL_HLT_LEP()
 	{
@@ -41,6 +52,7 @@ static double NT_sysweight_NOMINAL_HLT_LEP()
 	*/
 	return 1.;
 	}
+static T_branches NT_sysweight_NOMINAL_HLT_LEP_branches = {};
 
 static double NT_sysweight_NOMINAL_HLT_EL_MedTau()
 	{
@@ -49,6 +61,7 @@ static double NT_sysweight_NOMINAL_HLT_EL_MedTau()
 	// new, 2017 ntupler
 	return 1.; // NT_event_weight*NT_event_weight_PU*NT_event_weight_LEPmuID*NT_event_weight_LEPelID* NT_event_weight_LEPelTRG * NT_event_taus_SF_Medium[0];
 	}
+static T_branches NT_sysweight_NOMINAL_HLT_EL_MedTau_branches = {};
 
 static double NT_sysweight_NOMINAL_HLT_MU_MedTau()
 	{
@@ -56,6 +69,7 @@ static double NT_sysweight_NOMINAL_HLT_MU_MedTau()
 	//return NT_event_weight*0.95;
 	return 1.; // NT_event_weight*NT_event_weight_PU*NT_event_weight_LEPmuID*NT_event_weight_LEPelID* NT_event_weight_LEPmuTRG * NT_event_taus_SF_Medium[0];
 	}
+static T_branches NT_sysweight_NOMINAL_HLT_MU_MedTau_branches = {};
 
 static double NT_sysweight_NOMINAL_HLT_LEP_MedTau()
 	{
@@ -68,6 +82,7 @@ static double NT_sysweight_NOMINAL_HLT_LEP_MedTau()
 	double tau_weight = 1.;
 	return lep_weight * tau_weight;
 	}
+static T_branches NT_sysweight_NOMINAL_HLT_LEP_MedTau_branches = {};
 
 // systematic uncertainties from the nominal weight
 
@@ -75,12 +90,20 @@ static double NT_sysweight_NOMINAL()
 	{
 	return 1.;
 	}
+static T_branches NT_sysweight_NOMINAL_branches = {};
 
 #define NT_sysweight(sysname, weight_expr)   \
 static double NT_sysweight_ ##sysname(void)          \
 	{                                  \
 	return weight_expr; \
-	}
+	}                                  \
+static T_branches NT_sysweight_ ##sysname## _branches = branches_in_expression(#weight_expr);
+
+// the systematics without a variation of the weight share the NOMINAL function,
+// then sumup_loop records them once, as aliases of the NOMINAL
+#define NT_sysweight_as_NOMINAL(sysname)   \
+static const _F_sysweight NT_sysweight_ ##sysname = NT_sysweight_NOMINAL; \
+static T_branches NT_sysweight_ ##sysname## _branches = NT_sysweight_NOMINAL_branches;
 
 /* TODO all these are different in the ntupler -- check stage2.py how they are calculated
 
@@ -107,14 +130,14 @@ NT_sysweight(TAUIDDown, (NT_event_taus_SF_Medium_Down .size()>0 && NT_event_taus
 
 // TT_OBJ
 NT_sysweight(TOPPTUp   , NT_event_weight_toppt    )
-NT_sysweight(TOPPTDown , 1.    )
+NT_sysweight_as_NOMINAL(TOPPTDown )
 
 NT_sysweight(FragUp        , NT_event_weight_FragUp        )
 NT_sysweight(FragDown      , NT_event_weight_FragDown      )
 NT_sysweight(SemilepBRUp   , NT_event_weight_SemilepBRUp   )
 NT_sysweight(SemilepBRDown , NT_event_weight_SemilepBRDown )
 NT_sysweight(PetersonUp    , NT_event_weight_PetersonUp    )
-NT_sysweight(PetersonDown  , 1.                               )
+NT_sysweight_as_NOMINAL(PetersonDown  )
 
 // TT_HARD
 NT_sysweight(MrUp     , NT_event_weight_me_f_rUp )
@@ -188,78 +211,90 @@ NT_sysweight(PDFCT14n54Up    , NT_event_weight_pdf[53])
 NT_sysweight(PDFCT14n55Up    , NT_event_weight_pdf[54])
 NT_sysweight(PDFCT14n56Up    , NT_event_weight_pdf[55])
 
-NT_sysweight(PDFCT14n1Down     , 1.)
-NT_sysweight(PDFCT14n2Down     , 1.)
-NT_sysweight(PDFCT14n3Down     , 1.)
-NT_sysweight(PDFCT14n4Down     , 1.)
-NT_sysweight(PDFCT14n5Down     , 1.)
-NT_sysweight(PDFCT14n6Down     , 1.)
-NT_sysweight(PDFCT14n7Down     , 1.)
-NT_sysweight(PDFCT14n8Down     , 1.)
-NT_sysweight(PDFCT14n9Down     , 1.)
-NT_sysweight(PDFCT14n10Down    , 1.)
-NT_sysweight(PDFCT14n11Down    , 1.)
-NT_sysweight(PDFCT14n12Down    , 1.)
-NT_sysweight(PDFCT14n13Down    , 1.)
-NT_sysweight(PDFCT14n14Down    , 1.)
-NT_sysweight(PDFCT14n15Down    , 1.)
-NT_sysweight(PDFCT14n16Down    , 1.)
-NT_sysweight(PDFCT14n17Down    , 1.)
-NT_sysweight(PDFCT14n18Down    , 1.)
-NT_sysweight(PDFCT14n19Down    , 1.)
-NT_sysweight(PDFCT14n20Down    , 1.)
-NT_sysweight(PDFCT14n21Down    , 1.)
-NT_sysweight(PDFCT14n22Down    , 1.)
-NT_sysweight(PDFCT14n23Down    , 1.)
-NT_sysweight(PDFCT14n24Down    , 1.)
-NT_sysweight(PDFCT14n25Down    , 1.)
-NT_sysweight(PDFCT14n26Down    , 1.)
-NT_sysweight(PDFCT14n27Down    , 1.)
-NT_sysweight(PDFCT14n28Down    , 1.)
-NT_sysweight(PDFCT14n29Down    , 1.)
-NT_sysweight(PDFCT14n30Down    , 1.)
-NT_sysweight(PDFCT14n31Down    , 1.)
-NT_sysweight(PDFCT14n32Down    , 1.)
-NT_sysweight(PDFCT14n33Down    , 1.)
-NT_sysweight(PDFCT14n34Down    , 1.)
-NT_sysweight(PDFCT14n35Down    , 1.)
-NT_sysweight(PDFCT14n36Down    , 1.)
-NT_sysweight(PDFCT14n37Down    , 1.)
-NT_sysweight(PDFCT14n38Down    , 1.)
-NT_sysweight(PDFCT14n39Down    , 1.)
-NT_sysweight(PDFCT14n40Down    , 1.)
-NT_sysweight(PDFCT14n41Down    , 1.)
-NT_sysweight(PDFCT14n42Down    , 1.)
-NT_sysweight(PDFCT14n43Down    , 1.)
-NT_sysweight(PDFCT14n44Down    , 1.)
-NT_sysweight(PDFCT14n45Down    , 1.)
-NT_sysweight(PDFCT14n46Down    , 1.)
-NT_sysweight(PDFCT14n47Down    , 1.)
-NT_sysweight(PDFCT14n48Down    , 1.)
-NT_sysweight(PDFCT14n49Down    , 1.)
-NT_sysweight(PDFCT14n50Down    , 1.)
-NT_sysweight(PDFCT14n51Down    , 1.)
-NT_sysweight(PDFCT14n52Down    , 1.)
-NT_sysweight(PDFCT14n53Down    , 1.)
-NT_sysweight(PDFCT14n54Down    , 1.)
-NT_sysweight(PDFCT14n55Down    , 1.)
-NT_sysweight(PDFCT14n56Down    , 1.)
+NT_sysweight_as_NOMINAL(PDFCT14n1Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n2Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n3Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n4Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n5Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n6Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n7Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n8Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n9Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n10Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n11Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n12Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n13Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n14Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n15Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n16Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n17Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n18Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n19Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n20Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n21Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n22Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n23Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n24Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n25Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n26Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n27Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n28Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n29Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n30Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n31Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n32Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n33Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n34Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n35Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n36Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n37Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n38Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n39Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n40Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n41Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n42Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n43Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n44Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n45Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n46Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n47Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n48Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n49Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n50Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n51Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n52Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n53Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n54Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n55Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n56Down    )
 
 */
 
 
+// the reference of the sums of the systematic weights, before the channel selections
+// TODO the ntupler has no pile-up weight yet, the base weight is the generator weight
+static double NT_base_weight_gen()
+	{
+	return NT_aMCatNLO_weight;
+	}
+
+_S_base_weight_definition create_base_weight_definition_ntupler()
+	{
+	return {NT_base_weight_gen, NT_base_weight_gen, {"aMCatNLO_weight"}};
+	}
+
 // the systematic definitions:
 // a systematic can affect objects in the event, or the event weight
 // here the two types of systematics are separated:
 // the object systematics pass the systematic name for the objects, but have the NOMINAL event weight
 // the weight systematics pass the NOMINAL systematic for the objects, but the weight is there
-#define _quick_set_objsys(sysname) m[#sysname] = {sysname, NT_sysweight_NOMINAL}
-#define _quick_set_wgtsys(sysname) m[#sysname] = {NOMINAL, NT_sysweight_##sysname}
+#define _quick_set_objsys(sysname) m[#sysname] = {sysname, NT_sysweight_NOMINAL, NT_sysweight_NOMINAL_branches}
+#define _quick_set_wgtsys(sysname) m[#sysname] = {NOMINAL, NT_sysweight_##sysname, NT_sysweight_##sysname##_branches}
 
 T_known_defs_systs create_known_defs_systs_ntupler()
 	{
 	map<TString, _S_systematic_definition> m;
-	m["NOMINAL"] = {NOMINAL, NT_sysweight_NOMINAL};
+	m["NOMINAL"] = {NOMINAL, NT_sysweight_NOMINAL, NT_sysweight_NOMINAL_branches};
 
 	_quick_set_objsys(JERUp);
 	_quick_set_objsys(JERDown);
@@ -431,11 +466,13 @@ static double NT_distr_nvtx(ObjSystematics sys)
 	{
 	return NT_nvtx;
 	}
+static T_branches NT_distr_nvtx_branches = {"nvtx"};
 
 static double NT_distr_leading_lep_pt(ObjSystematics sys)
 	{
 	return NT_lep_p4[0].pt();
 	}
+static T_branches NT_distr_leading_lep_pt_branches = {"lep_p4"};
 
 static double NT_distr_dilep_mass(ObjSystematics sys)
 	{
@@ -446,6 +483,7 @@ static double NT_distr_dilep_mass(ObjSystematics sys)
 	else
 		return -111.;
 	}
+static T_branches NT_distr_dilep_mass_branches = {"lep_p4", "tau_p4"};
 
 static double NT_calc_leading_tau_energy_scale_correction(ObjSystematics sys)
 	{
@@ -453,6 +491,7 @@ static double NT_calc_leading_tau_energy_scale_correction(ObjSystematics sys)
 	else if (sys == TESDown) return NT_tau_decayMode[0] == 0 ? 0.995 - 0.012 : (NT_tau_decayMode[0] < 10 ? 1.011 - 0.012 : 1.006 - 0.012);
 	else                     return NT_tau_decayMode[0] == 0 ? 0.995         : (NT_tau_decayMode[0] < 10 ? 1.011         : 1.006        );
 	}
+static T_branches NT_calc_leading_tau_energy_scale_correction_branches = {"tau_decayMode"};
 
 static double NT_distr_tau_pt(ObjSystematics sys)
 	{
@@ -494,6 +533,7 @@ static double NT_distr_tau_pt(ObjSystematics sys)
 
 	return pt * NT_calc_leading_tau_energy_scale_correction(sys);
 	}
+static T_branches NT_distr_tau_pt_branches = branches_join({NT_calc_leading_tau_energy_scale_correction_branches, {"tau_p4"}});
 
 static double NT_calc_tau_sv_sign_geom(ObjSystematics sys)
 	{
@@ -508,11 +548,13 @@ static double NT_calc_tau_sv_sign_geom(ObjSystematics sys)
 	else
 		return -111.;
 	}
+static T_branches NT_calc_tau_sv_sign_geom_branches = {"tau_SV_fit_track_OS_matched_track_dR", "tau_SV_fit_track_SS1_matched_track_dR", "tau_SV_fit_track_SS2_matched_track_dR", "tau_SV_geom_flightLenSign", "tau_refited_index"};
 
 static double NT_distr_tau_sv_sign(ObjSystematics sys)
 	{
 	return NT_calc_tau_sv_sign_geom(sys);
 	}
+static T_branches NT_distr_tau_sv_sign_branches = NT_calc_tau_sv_sign_geom_branches;
 
 static double NT_distr_tau_sv_sign_pat(ObjSystematics sys)
 	{
@@ -532,6 +574,7 @@ static double NT_distr_tau_sv_sign_pat(ObjSystematics sys)
 	else
 		return -111.;
 	}
+static T_branches NT_distr_tau_sv_sign_pat_branches = {"tau_SV_fit_track_OS_matched_track_dR", "tau_SV_fit_track_SS1_matched_track_dR", "tau_SV_fit_track_SS2_matched_track_dR", "tau_flightLengthSignificance", "tau_refited_index"};
 
 static double NT_distr_sum_cos(ObjSystematics sys)
 	{
@@ -543,22 +586,26 @@ static double NT_distr_sum_cos(ObjSystematics sys)
 	double cos_tau_met = TMath::Cos(NT_tau_p4[0].Phi() - NT_met_init.Phi());
 	return cos_lep_met + cos_tau_met;
 	}
+static T_branches NT_distr_sum_cos_branches = {"lep_p4", "tau_p4", "met_init"};
 
 // TODO: these three are long calculations
 static double NT_distr_lj_var(ObjSystematics sys)
 	{
 	return -111.; //NT_event_jets_lj_var;
 	}
+static T_branches NT_distr_lj_var_branches = {};
 
 static double NT_distr_lj_var_w_mass(ObjSystematics sys)
 	{
 	return -111.; // NT_event_jets_lj_w_mass;
 	}
+static T_branches NT_distr_lj_var_w_mass_branches = {};
 
 static double NT_distr_lj_var_t_mass(ObjSystematics sys)
 	{
 	return -111.; // NT_event_jets_lj_t_mass;
 	}
+static T_branches NT_distr_lj_var_t_mass_branches = {};
 
 static double transverse_mass_pts(double v1_x, double v1_y, double v2_x, double v2_y)
 	{
@@ -594,6 +641,7 @@ static double NT_distr_Mt_lep_met(ObjSystematics sys)
 	double mT_init = transverse_mass_pts(NT_lep_p4[0].Px(), NT_lep_p4[0].Py(), NT_met_init.Px(), NT_met_init.Py());
 	return mT_init;
 	}
+static T_branches NT_distr_Mt_lep_met_branches = {"lep_p4", "met_init"};
 
 static double NT_distr_met(ObjSystematics sys)
 	{
@@ -611,6 +659,7 @@ static double NT_distr_met(ObjSystematics sys)
 
 	return NT_met_init.Pt();
 	}
+static T_branches NT_distr_met_branches = {"met_init"};
 
 
 
@@ -628,25 +677,25 @@ T_known_defs_distrs create_known_defs_distrs_ntupler()
 	// despicable!
 	// "sorry, unimplemented: non-trivial designated initializers not supported"
 
-	r = {50,  true,   0, 50};                                                      m["nvtx"] = {NT_distr_nvtx, r};
+	r = {50,  true,   0, 50};                                                      m["nvtx"] = {NT_distr_nvtx, r, NT_distr_nvtx_branches};
 
-	r = {40,  true,   0, 200};                                                     m["leading_lep_pt"] = {NT_distr_leading_lep_pt, r};
-	r = {40,  true,  30,  40};                                                     m["leading_lep_pt_el_edge35"] = {NT_distr_leading_lep_pt, r};
-	r = {40,  true,   0, 200};                                                     m["tau_pt"]         = {NT_distr_tau_pt, r};
+	r = {40,  true,   0, 200};                                                     m["leading_lep_pt"] = {NT_distr_leading_lep_pt, r, NT_distr_leading_lep_pt_branches};
+	r = {40,  true,  30,  40};                                                     m["leading_lep_pt_el_edge35"] = {NT_distr_leading_lep_pt, r, NT_distr_leading_lep_pt_branches};
+	r = {40,  true,   0, 200};                                                     m["tau_pt"]         = {NT_distr_tau_pt, r, NT_distr_tau_pt_branches};
 	// taus have smaller energy in ttbar, therefore we might want to look at a smaller range
-	r = {40,  true,   0, 150};                                                     m["tau_pt_range2"]   = {NT_distr_tau_pt, r};
-	r = {21,  true,  -1,  20};                                                     m["tau_sv_sign"]     = {NT_distr_tau_sv_sign, r};
-	r = {21,  true,  -1,  50};                                                     m["tau_sv_sign_pat"] = {NT_distr_tau_sv_sign_pat, r};
+	r = {40,  true,   0, 150};                                                     m["tau_pt_range2"]   = {NT_distr_tau_pt, r, NT_distr_tau_pt_branches};
+	r = {21,  true,  -1,  20};                                                     m["tau_sv_sign"]     = {NT_distr_tau_sv_sign, r, NT_distr_tau_sv_sign_branches};
+	r = {21,  true,  -1,  50};                                                     m["tau_sv_sign_pat"] = {NT_distr_tau_sv_sign_pat, r, NT_distr_tau_sv_sign_pat_branches};
 
-	r = {100, true,   0, 400};                                                     m["dilep_mass"]     = {NT_distr_dilep_mass, r};
-	r = {40,  true,  80, 100};                                                     m["dilep_mass_dy"]  = {NT_distr_dilep_mass, r};
-	r = {40,  true,  20, 120};                                                     m["dilep_mass_dy_tautau"]  = {NT_distr_dilep_mass, r};
+	r = {100, true,   0, 400};                                                     m["dilep_mass"]     = {NT_distr_dilep_mass, r, NT_distr_dilep_mass_branches};
+	r = {40,  true,  80, 100};                                                     m["dilep_mass_dy"]  = {NT_distr_dilep_mass, r, NT_distr_dilep_mass_branches};
+	r = {40,  true,  20, 120};                                                     m["dilep_mass_dy_tautau"]  = {NT_distr_dilep_mass, r, NT_distr_dilep_mass_branches};
 
-	r = {40,  true, -2., 2.};                                                      m["sum_cos"]        = {NT_distr_sum_cos, r};
+	r = {40,  true, -2., 2.};                                                      m["sum_cos"]        = {NT_distr_sum_cos, r, NT_distr_sum_cos_branches};
 
-	static double bins_lj_var[] = {0,15,30,45,60,90,120,170,220,270,400};   r = {(sizeof(bins_lj_var) / sizeof(bins_lj_var[0]))-1, false,-1,  -1, bins_lj_var};   m["lj_var"] = {NT_distr_lj_var, r};
-	static double bins_lj_var_w_mass[] = {10,40,65,80,95,120,150,200};      r = {(sizeof(bins_lj_var_w_mass) / sizeof(bins_lj_var_w_mass[0]))-1, false,-1,  -1, bins_lj_var_w_mass};   m["lj_var_w_mass"] = {NT_distr_lj_var_w_mass, r};
-	static double bins_lj_var_t_mass[] = {20,100,130,160,180,200,300,400};  r = {(sizeof(bins_lj_var_t_mass) / sizeof(bins_lj_var_t_mass[0]))-1, false,-1,  -1, bins_lj_var_t_mass};   m["lj_var_t_mass"] = {NT_distr_lj_var_t_mass, r};
+	static double bins_lj_var[] = {0,15,30,45,60,90,120,170,220,270,400};   r = {(sizeof(bins_lj_var) / sizeof(bins_lj_var[0]))-1, false,-1,  -1, bins_lj_var};   m["lj_var"] = {NT_distr_lj_var, r, NT_distr_lj_var_branches};
+	static double bins_lj_var_w_mass[] = {10,40,65,80,95,120,150,200};      r = {(sizeof(bins_lj_var_w_mass) / sizeof(bins_lj_var_w_mass[0]))-1, false,-1,  -1, bins_lj_var_w_mass};   m["lj_var_w_mass"] = {NT_distr_lj_var_w_mass, r, NT_distr_lj_var_w_mass_branches};
+	static double bins_lj_var_t_mass[] = {20,100,130,160,180,200,300,400};  r = {(sizeof(bins_lj_var_t_mass) / sizeof(bins_lj_var_t_mass[0]))-1, false,-1,  -1, bins_lj_var_t_mass};   m["lj_var_t_mass"] = {NT_distr_lj_var_t_mass, r, NT_distr_lj_var_t_mass_branches};
 
 	//r = {14, false,-1,  -1, .custom_bins=(double[]){0,16,32,44,54,64,74,81,88,95,104,116,132,160,250}}; m["Mt_lep_met_c"]   = {Mt_lep_met,     r};
 	//r = {2, false,-1,  -1, .custom_bins=(double[]){{0},{16},{32}}}; m["Mt_lep_met_c"]   = {Mt_lep_met,     r};
@@ -657,15 +706,15 @@ T_known_defs_distrs create_known_defs_distrs_ntupler()
 	// -- ok, this works
 	//r = {2, false,-1,  -1, (static double*){0.,16.,32.}}; m["Mt_lep_met_c"]   = {Mt_lep_met,     r};
 	//static double Mt_lep_met_c_bins[] = {0,16,32,44,54,64}; r = {5, false,-1,  -1, Mt_lep_met_c_bins}; m["Mt_lep_met_c"]   = {Mt_lep_met,     r};
-	static double bins_Mt_lep_met_c[] = {0,16,32,44,54,64,74,81,88,95,104,116,132,160,250}; r = {(sizeof(bins_Mt_lep_met_c) / sizeof(bins_Mt_lep_met_c[0]))-1, false,-1,  -1, bins_Mt_lep_met_c}; m["Mt_lep_met_c"]   = {NT_distr_Mt_lep_met,     r};
+	static double bins_Mt_lep_met_c[] = {0,16,32,44,54,64,74,81,88,95,104,116,132,160,250}; r = {(sizeof(bins_Mt_lep_met_c) / sizeof(bins_Mt_lep_met_c[0]))-1, false,-1,  -1, bins_Mt_lep_met_c}; m["Mt_lep_met_c"]   = {NT_distr_Mt_lep_met,     r, NT_distr_Mt_lep_met_branches};
 	// ok! this needs a wrapper-macro
 	//cerr_expr(r.custom_bins[0]);
 	//cerr_expr(r.custom_bins[1]);
 
-	r = {20, true,  0, 250};   m["Mt_lep_met_f"]   = {NT_distr_Mt_lep_met,     r};
-	r = {25, true,  0, 200};   m["met_f2"]         = {NT_distr_met, r};
-	r = {30, true,  0, 300};   m["met_f"]          = {NT_distr_met, r};
-	static double bins_met_c[] = {0,20,40,60,80,100,120,140,200,500}; r = {(sizeof(bins_met_c) / sizeof(bins_met_c[0]))-1, false,  -1, -1, bins_met_c};   m["met_c"]  = {NT_distr_met, r};
+	r = {20, true,  0, 250};   m["Mt_lep_met_f"]   = {NT_distr_Mt_lep_met,     r, NT_distr_Mt_lep_met_branches};
+	r = {25, true,  0, 200};   m["met_f2"]         = {NT_distr_met, r, NT_distr_met_branches};
+	r = {30, true,  0, 300};   m["met_f"]          = {NT_distr_met, r, NT_distr_met_branches};
+	static double bins_met_c[] = {0,20,40,60,80,100,120,140,200,500}; r = {(sizeof(bins_met_c) / sizeof(bins_met_c[0]))-1, false,  -1, -1, bins_met_c};   m["met_c"]  = {NT_distr_met, r, NT_distr_met_branches};
 
 	return m;
 }
@@ -701,7 +750,7 @@ static unsigned int TAUS_ID_CUT = TAUS_ID_CUT_VLoose; // # TAUS_ID_CUT_Medium #
 static bool ONLY_3PI_TAUS = false;
 static double SV_SIGN_CUT = 2.5;
 
-static unsigned int NT_calc_b_tagged_njets(ObjSystematics sys)
+static unsigned int _NT_calc_b_tagged_njets(ObjSystematics sys)
 	{
 	// TODO: correct
 	unsigned int n_bjets = 0;
@@ -719,6 +768,9 @@ static unsigned int NT_calc_b_tagged_njets(ObjSystematics sys)
 
 	return n_bjets;
 	}
+static T_branches _NT_calc_b_tagged_njets_branches = {"jet_PFID", "jet_b_discr", "jet_p4"};
+
+NT_calc_memoized(unsigned int, NT_calc_b_tagged_njets)
 
 typedef struct Triggers {
 	bool pass_mu;
@@ -730,7 +782,7 @@ typedef struct Triggers {
 	bool pass_mu_all;
 	bool pass_el_all;} Triggers;
 
-static Triggers NT_calc_triggers(ObjSystematics sys)
+static Triggers _NT_calc_triggers(ObjSystematics sys)
 	{
 	Triggers trigs;
 
@@ -783,8 +835,11 @@ static Triggers NT_calc_triggers(ObjSystematics sys)
 
 	return trigs;
 	}
+static T_branches _NT_calc_triggers_branches = {"HLT_el", "HLT_el_low_pt", "HLT_mu", "lep_alliso_matched_HLT", "lep_alliso_p4", "lep_dxy", "lep_dz", "lep_id", "lep_matched_HLT", "lep_p4", "lep_relIso", "leps_ID", "leps_ID_allIso", "nleps_veto_el_all", "nleps_veto_mu_all", "no_iso_veto_leps"};
+
+NT_calc_memoized(Triggers, NT_calc_triggers)
 
-static int NT_calc_channel_tt_selection_stages(ObjSystematics sys)
+static int _NT_calc_channel_tt_selection_stages(ObjSystematics sys)
 	{
 	int channel_stage = 0;
 
@@ -867,12 +922,16 @@ static int NT_calc_channel_tt_selection_stages(ObjSystematics sys)
 	*/
 	return channel_stage;
 	}
+static T_branches _NT_calc_channel_tt_selection_stages_branches = branches_join({_NT_calc_b_tagged_njets_branches, _NT_calc_triggers_branches, {"lep_id", "lep_p4", "tau_IDlev", "tau_id", "tau_p4"}});
+
+NT_calc_memoized(int, NT_calc_channel_tt_selection_stages)
 
 static bool NT_channel_mu_sel(ObjSystematics sys)
 	{
 	int channel_stage = NT_calc_channel_tt_selection_stages(sys);
 	return channel_stage == 9 || channel_stage == 7;
 	}
+static T_branches NT_channel_mu_sel_branches = _NT_calc_channel_tt_selection_stages_branches;
 
 static bool NT_channel_mu_sel_ss(ObjSystematics sys)
 	{
@@ -892,30 +951,35 @@ static bool NT_channel_mu_sel_ss(ObjSystematics sys)
 	int channel_stage = NT_calc_channel_tt_selection_stages(sys);
 	return channel_stage == 8 || channel_stage == 6;
 	}
+static T_branches NT_channel_mu_sel_ss_branches = _NT_calc_channel_tt_selection_stages_branches;
 
 static bool NT_channel_mu_sel_tauSV3(ObjSystematics sys)
 	{
 	bool sel = NT_channel_mu_sel(sys);
 	return sel ?  NT_calc_tau_sv_sign_geom(sys) > 3. : false;
 	}
+static T_branches NT_channel_mu_sel_tauSV3_branches = branches_join({NT_channel_mu_sel_branches, NT_calc_tau_sv_sign_geom_branches});
 
 static bool NT_channel_mu_sel_ss_tauSV3(ObjSystematics sys)
 	{
 	bool sel = NT_channel_mu_sel_ss(sys);
 	return sel ?  NT_calc_tau_sv_sign_geom(sys) > 3. : false;
 	}
+static T_branches NT_channel_mu_sel_ss_tauSV3_branches = branches_join({NT_channel_mu_sel_ss_branches, NT_calc_tau_sv_sign_geom_branches});
 
 static bool NT_channel_el_sel(ObjSystematics sys)
 	{
 	int channel_stage = NT_calc_channel_tt_selection_stages(sys);
 	return channel_stage == 19 || channel_stage == 17;
 	}
+static T_branches NT_channel_el_sel_branches = _NT_calc_channel_tt_selection_stages_branches;
 
 static bool NT_channel_el_sel_ss(ObjSystematics sys)
 	{
 	int channel_stage = NT_calc_channel_tt_selection_stages(sys);
 	return channel_stage == 18 || channel_stage == 16;
 	}
+static T_branches NT_channel_el_sel_ss_branches = _NT_calc_channel_tt_selection_stages_branches;
 
 
 static int NT_channel_tt_preselection_stages(ObjSystematics sys)
@@ -925,6 +989,7 @@ static int NT_channel_tt_preselection_stages(ObjSystematics sys)
 	// TODO: finish copying from stage2.py
 	return channel_stage;
 	}
+static T_branches NT_channel_tt_preselection_stages_branches = _NT_calc_triggers_branches;
 
 // old ntupler presel!! from xsec measurement
 static bool NT_channel_el_old_presel(ObjSystematics sys)
@@ -932,12 +997,14 @@ static bool NT_channel_el_old_presel(ObjSystematics sys)
 	int relevant_selection_stage = NT_channel_tt_preselection_stages(sys);
 	return (relevant_selection_stage == 19 || relevant_selection_stage == 17);
 	}
+static T_branches NT_channel_el_old_presel_branches = NT_channel_tt_preselection_stages_branches;
 
 static bool NT_channel_el_old_presel_ss(ObjSystematics sys)
 	{
 	int relevant_selection_stage = NT_channel_tt_preselection_stages(sys);
 	return (relevant_selection_stage == 18 || relevant_selection_stage == 16); // || relevant_selection_stage == 15);
 	}
+static T_branches NT_channel_el_old_presel_ss_branches = NT_channel_tt_preselection_stages_branches;
 
 static bool NT_channel_mu_old_presel(ObjSystematics sys)
 	{
@@ -945,12 +1012,14 @@ static bool NT_channel_mu_old_presel(ObjSystematics sys)
 	//return relevant_selection_stage == 9;
 	return (relevant_selection_stage == 9 || relevant_selection_stage == 7);
 	}
+static T_branches NT_channel_mu_old_presel_branches = NT_channel_tt_preselection_stages_branches;
 
 static bool NT_channel_mu_old_presel_ss(ObjSystematics sys)
 	{
 	int relevant_selection_stage = NT_channel_tt_preselection_stages(sys);
 	return (relevant_selection_stage == 8 || relevant_selection_stage == 6);
 	}
+static T_branches NT_channel_mu_old_presel_ss_branches = NT_channel_tt_preselection_stages_branches;
 
 
 static bool NT_channel_el_sel_tauSV3(ObjSystematics sys)
@@ -958,12 +1027,14 @@ static bool NT_channel_el_sel_tauSV3(ObjSystematics sys)
 	bool sel = NT_channel_el_sel(sys);
 	return sel ?  NT_calc_tau_sv_sign_geom(sys) > 3. : false;
 	}
+static T_branches NT_channel_el_sel_tauSV3_branches = branches_join({NT_channel_el_sel_branches, NT_calc_tau_sv_sign_geom_branches});
 
 static bool NT_channel_el_sel_ss_tauSV3(ObjSystematics sys)
 	{
 	bool sel = NT_channel_el_sel_ss(sys);
 	return sel ?  NT_calc_tau_sv_sign_geom(sys) > 3. : false;
 	}
+static T_branches NT_channel_el_sel_ss_tauSV3_branches = branches_join({NT_channel_el_sel_ss_branches, NT_calc_tau_sv_sign_geom_branches});
 
 // union os mu_sel and el_sel
 static bool NT_channel_lep_sel(ObjSystematics sys)
@@ -971,18 +1042,21 @@ static bool NT_channel_lep_sel(ObjSystematics sys)
 	int relevant_selection_stage = NT_calc_channel_tt_selection_stages(sys);
 	return relevant_selection_stage == 9 || relevant_selection_stage == 7 || relevant_selection_stage == 19 || relevant_selection_stage == 17;
 	}
+static T_branches NT_channel_lep_sel_branches = _NT_calc_channel_tt_selection_stages_branches;
 
 static bool NT_channel_lep_sel_ss(ObjSystematics sys)
 	{
 	int relevant_selection_stage = NT_calc_channel_tt_selection_stages(sys);
 	return relevant_selection_stage == 8 || relevant_selection_stage == 6 || relevant_selection_stage == 18 || relevant_selection_stage == 16;
 	}
+static T_branches NT_channel_lep_sel_ss_branches = _NT_calc_channel_tt_selection_stages_branches;
 
 static bool NT_channel_lep_sel_tauSV3(ObjSystematics sys)
 	{
 	bool sel = NT_channel_lep_sel(sys);
 	return sel ?  NT_calc_tau_sv_sign_geom(sys) > 3. : false;
 	}
+static T_branches NT_channel_lep_sel_tauSV3_branches = branches_join({NT_channel_lep_sel_branches, NT_calc_tau_sv_sign_geom_branches});
 
 static bool NT_channel_lep_sel_ss_tauSV3(ObjSystematics sys)
 	{
@@ -991,8 +1065,9 @@ static bool NT_channel_lep_sel_ss_tauSV3(ObjSystematics sys)
 	//return sel && NT_event_taus_sv_sign[0] > 3.;
 	return sel ?  NT_calc_tau_sv_sign_geom(sys) > 3. : false;
 	}
+static T_branches NT_channel_lep_sel_ss_tauSV3_branches = branches_join({NT_channel_lep_sel_ss_branches, NT_calc_tau_sv_sign_geom_branches});
 
-static int NT_calc_channel_tt_elmu_selection_stages(ObjSystematics sys)
+static int _NT_calc_channel_tt_elmu_selection_stages(ObjSystematics sys)
 	{
 	int channel_stage = 0;
 	Triggers trigs = NT_calc_triggers(sys);
@@ -1041,6 +1116,9 @@ static int NT_calc_channel_tt_elmu_selection_stages(ObjSystematics sys)
 
 	return channel_stage;
 	}
+static T_branches _NT_calc_channel_tt_elmu_selection_stages_branches = branches_join({_NT_calc_b_tagged_njets_branches, _NT_calc_triggers_branches, {"lep_id"}});
+
+NT_calc_memoized(int, NT_calc_channel_tt_elmu_selection_stages)
 
 
 static bool NT_channel_tt_elmu(ObjSystematics sys)
@@ -1048,16 +1126,18 @@ static bool NT_channel_tt_elmu(ObjSystematics sys)
 	int relevant_selection_stage = NT_calc_channel_tt_elmu_selection_stages(sys);
 	return relevant_selection_stage > 210 && relevant_selection_stage < 220;
 	}
+static T_branches NT_channel_tt_elmu_branches = _NT_calc_channel_tt_elmu_selection_stages_branches;
 
 static bool NT_channel_tt_elmu_tight(ObjSystematics sys)
 	{
 	int relevant_selection_stage = NT_calc_channel_tt_elmu_selection_stages(sys);
 	return relevant_selection_stage == 215;
 	}
+static T_branches NT_channel_tt_elmu_tight_branches = _NT_calc_channel_tt_elmu_selection_stages_branches;
 
 
 
-static int NT_calc_channel_dy_tautau_selection_stages(ObjSystematics sys)
+static int _NT_calc_channel_dy_tautau_selection_stages(ObjSystematics sys)
 	{
 	int channel_stage = 0;
 	Triggers trigs = NT_calc_triggers(sys);
@@ -1228,6 +1308,9 @@ static int NT_calc_channel_dy_tautau_selection_stages(ObjSystematics sys)
 
 	return channel_stage;
 	}
+static T_branches _NT_calc_channel_dy_tautau_selection_stages_branches = branches_join({_NT_calc_b_tagged_njets_branches, _NT_calc_triggers_branches, {"lep_id", "lep_p4", "tau_IDlev", "tau_decayMode", "tau_id", "tau_p4"}});
+
+NT_calc_memoized(int, NT_calc_channel_dy_tautau_selection_stages)
 
 
 static bool NT_channel_dy_mutau(ObjSystematics sys)
@@ -1236,6 +1319,7 @@ static bool NT_channel_dy_mutau(ObjSystematics sys)
 	double mT = NT_distr_Mt_lep_met(sys);
 	return mT < 40 && (relevant_selection_stage == 135 || relevant_selection_stage == 134 || relevant_selection_stage == 125 || relevant_selection_stage == 124);
 	}
+static T_branches NT_channel_dy_mutau_branches = branches_join({_NT_calc_channel_dy_tautau_selection_stages_branches, NT_distr_Mt_lep_met_branches});
 
 static bool NT_channel_dy_eltau(ObjSystematics sys)
 	{
@@ -1243,6 +1327,7 @@ static bool NT_channel_dy_eltau(ObjSystematics sys)
 	double mT = NT_distr_Mt_lep_met(sys);
 	return mT < 40 && (relevant_selection_stage == 235 || relevant_selection_stage == 234 || relevant_selection_stage == 225 || relevant_selection_stage == 224);
 	}
+static T_branches NT_channel_dy_eltau_branches = branches_join({_NT_calc_channel_dy_tautau_selection_stages_branches, NT_distr_Mt_lep_met_branches});
 
 static bool NT_channel_dy_mutau_ss(ObjSystematics sys)
 	{
@@ -1250,6 +1335,7 @@ static bool NT_channel_dy_mutau_ss(ObjSystematics sys)
 	double mT = NT_distr_Mt_lep_met(sys);
 	return mT < 40 && (relevant_selection_stage == 133 || relevant_selection_stage == 132 || relevant_selection_stage == 123 || relevant_selection_stage == 122);
 	}
+static T_branches NT_channel_dy_mutau_ss_branches = branches_join({_NT_calc_channel_dy_tautau_selection_stages_branches, NT_distr_Mt_lep_met_branches});
 
 static bool NT_channel_dy_eltau_ss(ObjSystematics sys)
 	{
@@ -1257,6 +1343,7 @@ static bool NT_channel_dy_eltau_ss(ObjSystematics sys)
 	double mT = NT_distr_Mt_lep_met(sys);
 	return mT < 40 && (relevant_selection_stage == 233 || relevant_selection_stage == 232 || relevant_selection_stage == 223 || relevant_selection_stage == 222);
 	}
+static T_branches NT_channel_dy_eltau_ss_branches = branches_join({_NT_calc_channel_dy_tautau_selection_stages_branches, NT_distr_Mt_lep_met_branches});
 
 static bool NT_channel_dy_mutau_tauSV3(ObjSystematics sys)
 	{
@@ -1264,26 +1351,30 @@ static bool NT_channel_dy_mutau_tauSV3(ObjSystematics sys)
 	// I use the if expression to be sure the vector NT_event_taus_sv_sign is not empty!
 	return sel ?  NT_calc_tau_sv_sign_geom(sys) > 3. : false;
 	}
+static T_branches NT_channel_dy_mutau_tauSV3_branches = branches_join({NT_channel_dy_mutau_branches, NT_calc_tau_sv_sign_geom_branches});
 static bool NT_channel_dy_mutau_ss_tauSV3(ObjSystematics sys)
 	{
 	bool sel = NT_channel_dy_mutau_ss(sys);
 	return sel ?  NT_calc_tau_sv_sign_geom(sys) > 3. : false;
 	}
+static T_branches NT_channel_dy_mutau_ss_tauSV3_branches = branches_join({NT_channel_dy_mutau_ss_branches, NT_calc_tau_sv_sign_geom_branches});
 
 static bool NT_channel_dy_eltau_tauSV3(ObjSystematics sys)
 	{
 	bool sel = NT_channel_dy_eltau(sys);
 	return sel ?  NT_calc_tau_sv_sign_geom(sys) > 3. : false;
 	}
+static T_branches NT_channel_dy_eltau_tauSV3_branches = branches_join({NT_channel_dy_eltau_branches, NT_calc_tau_sv_sign_geom_branches});
 static bool NT_channel_dy_eltau_ss_tauSV3(ObjSystematics sys)
 	{
 	bool sel = NT_channel_dy_eltau_ss(sys);
 	return sel ?  NT_calc_tau_sv_sign_geom(sys) > 3. : false;
 	}
+static T_branches NT_channel_dy_eltau_ss_tauSV3_branches = branches_join({NT_channel_dy_eltau_ss_branches, NT_calc_tau_sv_sign_geom_branches});
 
 
 
-static int NT_calc_channel_dy_elmu_selection_stages(ObjSystematics sys)
+static int _NT_calc_channel_dy_elmu_selection_stages(ObjSystematics sys)
 	{
 	int channel_stage = 0;
 	//pass_mu, pass_elmu, pass_elmu_el, pass_mumu, pass_elel, pass_el, pass_mu_all, pass_el_all = passed_triggers
@@ -1313,6 +1404,9 @@ static int NT_calc_channel_dy_elmu_selection_stages(ObjSystematics sys)
 
 	return channel_stage;
 	}
+static T_branches _NT_calc_channel_dy_elmu_selection_stages_branches = branches_join({_NT_calc_b_tagged_njets_branches, _NT_calc_triggers_branches, {"lep_id"}});
+
+NT_calc_memoized(int, NT_calc_channel_dy_elmu_selection_stages)
 
 
 static bool NT_channel_dy_elmu(ObjSystematics sys)
@@ -1320,15 +1414,17 @@ static bool NT_channel_dy_elmu(ObjSystematics sys)
 	int relevant_selection_stage = NT_calc_channel_dy_elmu_selection_stages(sys);
 	return relevant_selection_stage == 105;
 	}
+static T_branches NT_channel_dy_elmu_branches = _NT_calc_channel_dy_elmu_selection_stages_branches;
 
 static bool NT_channel_dy_elmu_ss(ObjSystematics sys)
 	{
 	int relevant_selection_stage = NT_calc_channel_dy_elmu_selection_stages(sys);
 	return relevant_selection_stage == 103;
 	}
+static T_branches NT_channel_dy_elmu_ss_branches = _NT_calc_channel_dy_elmu_selection_stages_branches;
 
 
-static int NT_calc_channel_dy_mumu_selection_stages(ObjSystematics sys)
+static int _NT_calc_channel_dy_mumu_selection_stages(ObjSystematics sys)
 	{
 	int channel_stage = 0;
 	//pass_mu, pass_elmu, pass_elmu_el, pass_mumu, pass_elel, pass_el, pass_mu_all, pass_el_all = passed_triggers
@@ -1369,6 +1465,9 @@ static int NT_calc_channel_dy_mumu_selection_stages(ObjSystematics sys)
 
 	return channel_stage;
 	}
+static T_branches _NT_calc_channel_dy_mumu_selection_stages_branches = branches_join({_NT_calc_b_tagged_njets_branches, _NT_calc_triggers_branches, {"lep_id", "lep_p4"}});
+
+NT_calc_memoized(int, NT_calc_channel_dy_mumu_selection_stages)
 
 
 static bool NT_channel_dy_mumu(ObjSystematics sys)
@@ -1376,16 +1475,18 @@ static bool NT_channel_dy_mumu(ObjSystematics sys)
 	int relevant_selection_stage = NT_calc_channel_dy_mumu_selection_stages(sys);
 	return relevant_selection_stage == 102 || relevant_selection_stage == 103 || relevant_selection_stage == 105;
 	}
+static T_branches NT_channel_dy_mumu_branches = _NT_calc_channel_dy_mumu_selection_stages_branches;
 
 static bool NT_channel_dy_elel(ObjSystematics sys)
 	{
 	int relevant_selection_stage = NT_calc_channel_dy_mumu_selection_stages(sys);
 	return relevant_selection_stage == 112 || relevant_selection_stage == 113 || relevant_selection_stage == 115;
 	}
+static T_branches NT_channel_dy_elel_branches = _NT_calc_channel_dy_mumu_selection_stages_branches;
 
 
 
-#define _quick_set_chandef(m, chan_name, sel_weight_func) m[#chan_name] = {NT_channel_ ## chan_name, sel_weight_func}
+#define _quick_set_chandef(m, chan_name, sel_weight_func) m[#chan_name] = {NT_channel_ ## chan_name, sel_weight_func, branches_join({NT_channel_ ## chan_name ## _branches, sel_weight_func ## _branches})}
 
 /** \brief The initialization function for the `bool` functions of the known distributions in the ntupler output ntuples.
 
@@ -1571,6 +1672,7 @@ static int NT_calc_gen_proc_id_tt()
 		return genproc_tt_other;
 		};
 	}
+static T_branches NT_calc_gen_proc_id_tt_branches = {"gen_t_w_decay_id", "gen_tb_w_decay_id"};
 
 static int NT_calc_gen_proc_id_dy()
 	{
@@ -1595,6 +1697,7 @@ static int NT_calc_gen_proc_id_dy()
 		return genproc_dy_other;
 		}
 	}
+static T_branches NT_calc_gen_proc_id_dy_branches = {"gen_N_zdecays", "gen_zdecays_IDs", "gen_pythia8_prompt_leptons_IDs"};
 
 static int NT_calc_gen_proc_id_wjets()
 	{
@@ -1623,6 +1726,7 @@ static int NT_calc_gen_proc_id_wjets()
 		return genproc_wjets;
 		}
 	}
+static T_branches NT_calc_gen_proc_id_wjets_branches = {"gen_N_wdecays", "gen_wdecays_IDs", "gen_pythia8_prompt_leptons_IDs"};
 
 static int NT_calc_gen_proc_id_single_top()
 	{
@@ -1660,6 +1764,7 @@ static int NT_calc_gen_proc_id_single_top()
 		return genproc_stop_other;
 		}
 	}
+static T_branches NT_calc_gen_proc_id_single_top_branches = {"gen_t_w_decay_id", "gen_tb_w_decay_id", "gen_wdecays_IDs"};
 
 static bool NT_genproc_tt_eltau3ch()
 	{
@@ -1824,7 +1929,9 @@ T_known_defs_procs create_known_defs_procs_ntupler()
 			{"dy_mumu",       _mumu_tt_procs},
 			{"dy_elel",       _mumu_tt_procs},
 
-			}
+			},
+		.branches = NT_calc_gen_proc_id_tt_branches,
+		.gen_proc_id = NT_calc_gen_proc_id_tt,
 		};
 
 	m["dy"] = {
@@ -1867,7 +1974,9 @@ T_known_defs_procs create_known_defs_procs_ntupler()
 			{"dy_elel",       _incl_dy_procs},
 			{"dy_elmu",       _leptau_dy_procs},
 			{"dy_elmu_ss",    _leptau_dy_procs},
-			}
+			},
+		.branches = NT_calc_gen_proc_id_dy_branches,
+		.gen_proc_id = NT_calc_gen_proc_id_dy,
 		};
 
 	m["stop"] = {
@@ -1913,7 +2022,9 @@ T_known_defs_procs create_known_defs_procs_ntupler()
 			{"dy_elel",        _mumu_stop_procs},
 			{"dy_elmu",       _elmu_stop_procs},
 			{"dy_elmu_ss",    _elmu_stop_procs},
-			}
+			},
+		.branches = NT_calc_gen_proc_id_single_top_branches,
+		.gen_proc_id = NT_calc_gen_proc_id_single_top,
 		};
 
 	m["wjets"] = {
@@ -1957,7 +2068,9 @@ T_known_defs_procs create_known_defs_procs_ntupler()
 			{"dy_elel",        _mumu_wjets_procs},
 			{"dy_elmu",       _elmu_wjets_procs},
 			{"dy_elmu_ss",    _elmu_wjets_procs},
-			}
+			},
+		.branches = NT_calc_gen_proc_id_wjets_branches,
+		.gen_proc_id = NT_calc_gen_proc_id_wjets,
 		};
 
 	m["qcd"] = {
@@ -1997,7 +2110,8 @@ T_known_defs_procs create_known_defs_procs_ntupler()
 			{"dy_elel",       _any_procs},
 			{"dy_elmu",       _any_procs},
 			{"dy_elmu_ss",    _any_procs},
-			}
+			},
+		.branches = {},
 		};
 
 
@@ -2037,7 +2151,8 @@ T_known_defs_procs create_known_defs_procs_ntupler()
 			{"dy_elel",       {}},
 			{"dy_elmu",       {}},
 			{"dy_elmu_ss",    {}},
-			}
+			},
+		.branches = {},
 		};
 
 
@@ -2289,6 +2404,10 @@ int connect_ntuple_interface_ntupler(TTree* NT_output_ttree)
 	#define NTUPLE_INTERFACE_CONNECT
 	#include "ntupler_interface.h" // it runs a bunch of branch-connecting commands on TTree* with name OUTNTUPLE
 
+	// invalidate the memoized NT_calc_* results of the previously connected ttree
+	NT_memo_ttree = NT_output_ttree;
+	NT_memo_generation++;
+
 	return 0;
 	}
 
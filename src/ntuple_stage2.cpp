@@ -2,9 +2,18 @@
 #include "UserCode/proc/interface/ntuple_stage2.h"
 
 /* Global interface to the ttree, the name space for all the event-processing fucntions.
+ * The buffers are thread_local: each thread of sumup_loop connects its own TTree.
  */
+#define NTUPLE_INTERFACE_DECLARE_THREAD_LOCAL
 #define NTUPLE_INTERFACE_CLASS_DECLARE
 #include "stage2_interface.h"
+#undef NTUPLE_INTERFACE_DECLARE_THREAD_LOCAL
+
+#include <bitset>
+
+/* the state of NT_calc_memoized */
+static thread_local TTree*        NT_memo_ttree = NULL;
+static thread_local unsigned long NT_memo_generation = 0;
 
 /* --------------------------------------------------------------- */
 /* STD DEFS */
@@ -21,11 +30,13 @@ static double NT_sysweight_NOMINAL_HLT_EL()
 	{
 	return NT_event_weight*NT_event_weight_PU*NT_event_weight_LEPmuID*NT_event_weight_LEPelID* NT_event_weight_LEPelTRG;
 	}
+static T_branches NT_sysweight_NOMINAL_HLT_EL_branches = {"event_weight", "event_weight_PU", "event_weight_LEPmuID", "event_weight_LEPelID", "event_weight_LEPelTRG"};
 
 static double NT_sysweight_NOMINAL_HLT_MU()
 	{
 	return NT_event_weight*NT_event_weight_PU*NT_event_weight_LEPmuID*NT_event_weight_LEPelID* NT_event_weight_LEPmuTRG;
 	}
+static T_branches NT_sysweight_NOMINAL_HLT_MU_branches = {"event_weight", "event_weight_PU", "event_weight_LEPmuID", "event_weight_LEPelID", "event_weight_LEPmuTRG"};
 
 static double NT_sysweight_NOMINAL_HLT_LEP()
 	{
@@ -35,6 +46,7 @@ static double NT_sysweight_NOMINAL_HLT_LEP()
 	else
 		return  NT_event_weight_LEPelTRG * common;
 	}
+static T_branches NT_sysweight_NOMINAL_HLT_LEP_branches = {"event_weight", "event_weight_PU", "event_weight_LEPmuID", "event_weight_LEPelID", "event_weight_LEPmuTRG", "event_weight_LEPelTRG", "event_leptons_ids"};
 
 static double NT_sysweight_NOMINAL_HLT_EL_MedTau()
 	{
@@ -43,6 +55,7 @@ static double NT_sysweight_NOMINAL_HLT_EL_MedTau()
 	// new, 2017 stage2
 	return NT_event_weight*NT_event_weight_PU*NT_event_weight_LEPmuID*NT_event_weight_LEPelID* NT_event_weight_LEPelTRG * NT_event_taus_SF_Medium[0];
 	}
+static T_branches NT_sysweight_NOMINAL_HLT_EL_MedTau_branches = {"event_weight", "event_weight_PU", "event_weight_LEPmuID", "event_weight_LEPelID", "event_weight_LEPelTRG", "event_taus_SF_Medium"};
 
 static double NT_sysweight_NOMINAL_HLT_MU_MedTau()
 	{
@@ -50,6 +63,7 @@ static double NT_sysweight_NOMINAL_HLT_MU_MedTau()
 	//return NT_event_weight*0.95;
 	return NT_event_weight*NT_event_weight_PU*NT_event_weight_LEPmuID*NT_event_weight_LEPelID* NT_event_weight_LEPmuTRG * NT_event_taus_SF_Medium[0];
 	}
+static T_branches NT_sysweight_NOMINAL_HLT_MU_MedTau_branches = {"event_weight", "event_weight_PU", "event_weight_LEPmuID", "event_weight_LEPelID", "event_weight_LEPmuTRG", "event_taus_SF_Medium"};
 
 static double NT_sysweight_NOMINAL_HLT_LEP_MedTau()
 	{
@@ -61,6 +75,7 @@ static double NT_sysweight_NOMINAL_HLT_LEP_MedTau()
 	double lep_weight = NT_sysweight_NOMINAL_HLT_LEP();
 	return lep_weight * NT_event_taus_SF_Medium[0];
 	}
+static T_branches NT_sysweight_NOMINAL_HLT_LEP_MedTau_branches = branches_join({NT_sysweight_NOMINAL_HLT_LEP_branches, {"event_taus_SF_Medium"}});
 
 // systematic uncertainties from the nominal weight
 
@@ -68,12 +83,20 @@ static double NT_sysweight_NOMINAL()
 	{
 	return 1.;
 	}
+static T_branches NT_sysweight_NOMINAL_branches = {};
 
 #define NT_sysweight(sysname, weight_expr)   \
 static double NT_sysweight_ ##sysname(void)          \
 	{                                  \
 	return weight_expr; \
-	}
+	}                                  \
+static T_branches NT_sysweight_ ##sysname## _branches = branches_in_expression(#weight_expr);
+
+// the systematics without a variation of the weight share the NOMINAL function,
+// then sumup_loop records them once, as aliases of the NOMINAL
+#define NT_sysweight_as_NOMINAL(sysname)   \
+static const _F_sysweight NT_sysweight_ ##sysname = NT_sysweight_NOMINAL; \
+static T_branches NT_sysweight_ ##sysname## _branches = NT_sysweight_NOMINAL_branches;
 
 // COMMON systematics
 NT_sysweight(PUUp,   NT_event_weight_PUUp   / NT_event_weight_PU )
@@ -98,14 +121,14 @@ NT_sysweight(TAUIDDown, (NT_event_taus_SF_Medium_Down .size()>0 && NT_event_taus
 
 // TT_OBJ
 NT_sysweight(TOPPTUp   , NT_event_weight_toppt    )
-NT_sysweight(TOPPTDown , 1.    )
+NT_sysweight_as_NOMINAL(TOPPTDown )
 
 NT_sysweight(FragUp        , NT_event_weight_FragUp        )
 NT_sysweight(FragDown      , NT_event_weight_FragDown      )
 NT_sysweight(SemilepBRUp   , NT_event_weight_SemilepBRUp   )
 NT_sysweight(SemilepBRDown , NT_event_weight_SemilepBRDown )
 NT_sysweight(PetersonUp    , NT_event_weight_PetersonUp    )
-NT_sysweight(PetersonDown  , 1.                               )
+NT_sysweight_as_NOMINAL(PetersonDown  )
 
 // TT_HARD
 NT_sysweight(MrUp     , NT_event_weight_me_f_rUp )
@@ -179,72 +202,87 @@ NT_sysweight(PDFCT14n54Up    , NT_event_weight_pdf[53])
 NT_sysweight(PDFCT14n55Up    , NT_event_weight_pdf[54])
 NT_sysweight(PDFCT14n56Up    , NT_event_weight_pdf[55])
 
-NT_sysweight(PDFCT14n1Down     , 1.)
-NT_sysweight(PDFCT14n2Down     , 1.)
-NT_sysweight(PDFCT14n3Down     , 1.)
-NT_sysweight(PDFCT14n4Down     , 1.)
-NT_sysweight(PDFCT14n5Down     , 1.)
-NT_sysweight(PDFCT14n6Down     , 1.)
-NT_sysweight(PDFCT14n7Down     , 1.)
-NT_sysweight(PDFCT14n8Down     , 1.)
-NT_sysweight(PDFCT14n9Down     , 1.)
-NT_sysweight(PDFCT14n10Down    , 1.)
-NT_sysweight(PDFCT14n11Down    , 1.)
-NT_sysweight(PDFCT14n12Down    , 1.)
-NT_sysweight(PDFCT14n13Down    , 1.)
-NT_sysweight(PDFCT14n14Down    , 1.)
-NT_sysweight(PDFCT14n15Down    , 1.)
-NT_sysweight(PDFCT14n16Down    , 1.)
-NT_sysweight(PDFCT14n17Down    , 1.)
-NT_sysweight(PDFCT14n18Down    , 1.)
-NT_sysweight(PDFCT14n19Down    , 1.)
-NT_sysweight(PDFCT14n20Down    , 1.)
-NT_sysweight(PDFCT14n21Down    , 1.)
-NT_sysweight(PDFCT14n22Down    , 1.)
-NT_sysweight(PDFCT14n23Down    , 1.)
-NT_sysweight(PDFCT14n24Down    , 1.)
-NT_sysweight(PDFCT14n25Down    , 1.)
-NT_sysweight(PDFCT14n26Down    , 1.)
-NT_sysweight(PDFCT14n27Down    , 1.)
-NT_sysweight(PDFCT14n28Down    , 1.)
-NT_sysweight(PDFCT14n29Down    , 1.)
-NT_sysweight(PDFCT14n30Down    , 1.)
-NT_sysweight(PDFCT14n31Down    , 1.)
-NT_sysweight(PDFCT14n32Down    , 1.)
-NT_sysweight(PDFCT14n33Down    , 1.)
-NT_sysweight(PDFCT14n34Down    , 1.)
-NT_sysweight(PDFCT14n35Down    , 1.)
-NT_sysweight(PDFCT14n36Down    , 1.)
-NT_sysweight(PDFCT14n37Down    , 1.)
-NT_sysweight(PDFCT14n38Down    , 1.)
-NT_sysweight(PDFCT14n39Down    , 1.)
-NT_sysweight(PDFCT14n40Down    , 1.)
-NT_sysweight(PDFCT14n41Down    , 1.)
-NT_sysweight(PDFCT14n42Down    , 1.)
-NT_sysweight(PDFCT14n43Down    , 1.)
-NT_sysweight(PDFCT14n44Down    , 1.)
-NT_sysweight(PDFCT14n45Down    , 1.)
-NT_sysweight(PDFCT14n46Down    , 1.)
-NT_sysweight(PDFCT14n47Down    , 1.)
-NT_sysweight(PDFCT14n48Down    , 1.)
-NT_sysweight(PDFCT14n49Down    , 1.)
-NT_sysweight(PDFCT14n50Down    , 1.)
-NT_sysweight(PDFCT14n51Down    , 1.)
-NT_sysweight(PDFCT14n52Down    , 1.)
-NT_sysweight(PDFCT14n53Down    , 1.)
-NT_sysweight(PDFCT14n54Down    , 1.)
-NT_sysweight(PDFCT14n55Down    , 1.)
-NT_sysweight(PDFCT14n56Down    , 1.)
-
-
-
-#define _quick_set_objsys(sysname) m[#sysname] = {sysname, NT_sysweight_NOMINAL}
-#define _quick_set_wgtsys(sysname) m[#sysname] = {NOMINAL, NT_sysweight_##sysname}
+NT_sysweight_as_NOMINAL(PDFCT14n1Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n2Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n3Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n4Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n5Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n6Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n7Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n8Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n9Down     )
+NT_sysweight_as_NOMINAL(PDFCT14n10Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n11Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n12Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n13Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n14Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n15Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n16Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n17Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n18Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n19Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n20Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n21Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n22Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n23Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n24Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n25Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n26Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n27Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n28Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n29Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n30Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n31Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n32Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n33Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n34Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n35Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n36Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n37Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n38Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n39Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n40Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n41Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n42Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n43Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n44Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n45Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n46Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n47Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n48Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n49Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n50Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n51Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n52Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n53Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n54Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n55Down    )
+NT_sysweight_as_NOMINAL(PDFCT14n56Down    )
+
+
+// the reference of the sums of the systematic weights, before the channel selections
+static double NT_base_weight_gen()
+	{
+	return NT_event_weight;
+	}
+
+static double NT_base_weight_gen_PU()
+	{
+	return NT_event_weight*NT_event_weight_PU;
+	}
+
+_S_base_weight_definition create_base_weight_definition_stage2()
+	{
+	return {NT_base_weight_gen, NT_base_weight_gen_PU, {"event_weight", "event_weight_PU"}};
+	}
+
+#define _quick_set_objsys(sysname) m[#sysname] = {sysname, NT_sysweight_NOMINAL, NT_sysweight_NOMINAL_branches}
+#define _quick_set_wgtsys(sysname) m[#sysname] = {NOMINAL, NT_sysweight_##sysname, NT_sysweight_##sysname##_branches}
 
 T_known_defs_systs create_known_defs_systs_stage2()
 	{
 	map<TString, _S_systematic_definition> m;
-	m["NOMINAL"] = {NOMINAL, NT_sysweight_NOMINAL};
+	m["NOMINAL"] = {NOMINAL, NT_sysweight_NOMINAL, NT_sysweight_NOMINAL_branches};
 
 	_quick_set_objsys(JERUp);
 	_quick_set_objsys(JERDown);
@@ -414,11 +452,13 @@ static double NT_distr_nvtx(ObjSystematics sys)
 	{
 	return NT_nvtx;
 	}
+static T_branches NT_distr_nvtx_branches = {"nvtx"};
 
 static double NT_distr_leading_lep_pt(ObjSystematics sys)
 	{
 	return NT_event_leptons[0].pt();
 	}
+static T_branches NT_distr_leading_lep_pt_branches = {"event_leptons"};
 
 static double NT_distr_dilep_mass(ObjSystematics sys)
 	{
@@ -429,8 +469,9 @@ static double NT_distr_dilep_mass(ObjSystematics sys)
 	else
 		return -111.;
 	}
+static T_branches NT_distr_dilep_mass_branches = {"event_leptons", "event_taus"};
 
-static double NT_distr_tau_pt(ObjSystematics sys)
+template<ObjSystematics sys> static double _NT_distr_tau_pt(void)
 	{
 
 	// from stage2.py and std_defs.py:
@@ -450,6 +491,8 @@ static double NT_distr_tau_pt(ObjSystematics sys)
 	else if (sys == TESDown) return pt * NT_event_taus_TES_down[0];
 	else                     return pt;
 	}
+NT_distr_per_obj_sys(NT_distr_tau_pt)
+static T_branches NT_distr_tau_pt_branches = {"event_taus", "event_taus_TES_up", "event_taus_TES_down"};
 
 static double NT_distr_tau_sv_sign(ObjSystematics sys)
 	{
@@ -458,6 +501,7 @@ static double NT_distr_tau_sv_sign(ObjSystematics sys)
 	else
 		return -111.;
 	}
+static T_branches NT_distr_tau_sv_sign_branches = {"event_taus_sv_sign"};
 
 static double NT_distr_sum_cos(ObjSystematics sys)
 	{
@@ -466,24 +510,28 @@ static double NT_distr_sum_cos(ObjSystematics sys)
 	double cos_tau_met = TMath::Cos(NT_event_taus[0]   .Phi() - NT_event_met.Phi());
 	return cos_lep_met + cos_tau_met;
 	}
+static T_branches NT_distr_sum_cos_branches = {"event_leptons", "event_taus", "event_met"};
 
 
 static double NT_distr_lj_var(ObjSystematics sys)
 	{
 	return NT_event_jets_lj_var;
 	}
+static T_branches NT_distr_lj_var_branches = {"event_jets_lj_var"};
 
 static double NT_distr_lj_var_w_mass(ObjSystematics sys)
 	{
 	return NT_event_jets_lj_w_mass;
 	}
+static T_branches NT_distr_lj_var_w_mass_branches = {"event_jets_lj_w_mass"};
 
 static double NT_distr_lj_var_t_mass(ObjSystematics sys)
 	{
 	return NT_event_jets_lj_t_mass;
 	}
+static T_branches NT_distr_lj_var_t_mass_branches = {"event_jets_lj_t_mass"};
 
-static double NT_distr_Mt_lep_met(ObjSystematics sys)
+template<ObjSystematics sys> static double _NT_distr_Mt_lep_met(void)
 	{
 
 	if      (sys == NOMINAL) return NT_event_met_lep_mt;
@@ -496,8 +544,10 @@ static double NT_distr_Mt_lep_met(ObjSystematics sys)
 
 	else return NT_event_met_lep_mt;
 	}
+NT_distr_per_obj_sys(NT_distr_Mt_lep_met)
+static T_branches NT_distr_Mt_lep_met_branches = {"event_met_lep_mt", "event_met_lep_mt%s"};
 
-static double NT_distr_met(ObjSystematics sys)
+template<ObjSystematics sys> static double _NT_distr_met(void)
 	{
 
 	if      (sys == NOMINAL) return NT_event_met.pt();
@@ -510,6 +560,8 @@ static double NT_distr_met(ObjSystematics sys)
 
 	else return NT_event_met.pt();
 	}
+NT_distr_per_obj_sys(NT_distr_met)
+static T_branches NT_distr_met_branches = {"event_met", "event_met%s"};
 
 
 
@@ -527,24 +579,24 @@ T_known_defs_distrs create_known_defs_distrs_stage2()
 	// despicable!
 	// "sorry, unimplemented: non-trivial designated initializers not supported"
 
-	r = {50,  true,   0, 50};                                                      m["nvtx"] = {NT_distr_nvtx, r};
+	r = {50,  true,   0, 50};                                                      m["nvtx"] = {NT_distr_nvtx, r, NT_distr_nvtx_branches};
 
-	r = {40,  true,   0, 200};                                                     m["leading_lep_pt"] = {NT_distr_leading_lep_pt, r};
-	r = {40,  true,  30,  40};                                                     m["leading_lep_pt_el_edge35"] = {NT_distr_leading_lep_pt, r};
-	r = {40,  true,   0, 200};                                                     m["tau_pt"]         = {NT_distr_tau_pt, r};
+	r = {40,  true,   0, 200};                                                     m["leading_lep_pt"] = {NT_distr_leading_lep_pt, r, NT_distr_leading_lep_pt_branches};
+	r = {40,  true,  30,  40};                                                     m["leading_lep_pt_el_edge35"] = {NT_distr_leading_lep_pt, r, NT_distr_leading_lep_pt_branches};
+	r = {40,  true,   0, 200};                                                     m["tau_pt"]         = {NT_distr_tau_pt, r, NT_distr_tau_pt_branches, NT_distr_tau_pt_per_sys};
 	// taus have smaller energy in ttbar, therefore we might want to look at a smaller range
-	r = {40,  true,   0, 150};                                                     m["tau_pt_range2"]  = {NT_distr_tau_pt, r};
-	r = {21,  true,  -1,  20};                                                     m["tau_sv_sign"]    = {NT_distr_tau_sv_sign, r};
+	r = {40,  true,   0, 150};                                                     m["tau_pt_range2"]  = {NT_distr_tau_pt, r, NT_distr_tau_pt_branches, NT_distr_tau_pt_per_sys};
+	r = {21,  true,  -1,  20};                                                     m["tau_sv_sign"]    = {NT_distr_tau_sv_sign, r, NT_distr_tau_sv_sign_branches};
 
-	r = {100, true,   0, 400};                                                     m["dilep_mass"]     = {NT_distr_dilep_mass, r};
-	r = {40,  true,  80, 100};                                                     m["dilep_mass_dy"]  = {NT_distr_dilep_mass, r};
-	r = {40,  true,  20, 120};                                                     m["dilep_mass_dy_tautau"]  = {NT_distr_dilep_mass, r};
+	r = {100, true,   0, 400};                                                     m["dilep_mass"]     = {NT_distr_dilep_mass, r, NT_distr_dilep_mass_branches};
+	r = {40,  true,  80, 100};                                                     m["dilep_mass_dy"]  = {NT_distr_dilep_mass, r, NT_distr_dilep_mass_branches};
+	r = {40,  true,  20, 120};                                                     m["dilep_mass_dy_tautau"]  = {NT_distr_dilep_mass, r, NT_distr_dilep_mass_branches};
 
-	r = {40,  true, -2., 2.};                                                      m["sum_cos"]        = {NT_distr_sum_cos, r};
+	r = {40,  true, -2., 2.};                                                      m["sum_cos"]        = {NT_distr_sum_cos, r, NT_distr_sum_cos_branches};
 
-	static double bins_lj_var[] = {0,15,30,45,60,90,120,170,220,270,400};   r = {(sizeof(bins_lj_var) / sizeof(bins_lj_var[0]))-1, false,-1,  -1, bins_lj_var};   m["lj_var"] = {NT_distr_lj_var, r};
-	static double bins_lj_var_w_mass[] = {10,40,65,80,95,120,150,200};      r = {(sizeof(bins_lj_var_w_mass) / sizeof(bins_lj_var_w_mass[0]))-1, false,-1,  -1, bins_lj_var_w_mass};   m["lj_var_w_mass"] = {NT_distr_lj_var_w_mass, r};
-	static double bins_lj_var_t_mass[] = {20,100,130,160,180,200,300,400};  r = {(sizeof(bins_lj_var_t_mass) / sizeof(bins_lj_var_t_mass[0]))-1, false,-1,  -1, bins_lj_var_t_mass};   m["lj_var_t_mass"] = {NT_distr_lj_var_t_mass, r};
+	static double bins_lj_var[] = {0,15,30,45,60,90,120,170,220,270,400};   r = {(sizeof(bins_lj_var) / sizeof(bins_lj_var[0]))-1, false,-1,  -1, bins_lj_var};   m["lj_var"] = {NT_distr_lj_var, r, NT_distr_lj_var_branches};
+	static double bins_lj_var_w_mass[] = {10,40,65,80,95,120,150,200};      r = {(sizeof(bins_lj_var_w_mass) / sizeof(bins_lj_var_w_mass[0]))-1, false,-1,  -1, bins_lj_var_w_mass};   m["lj_var_w_mass"] = {NT_distr_lj_var_w_mass, r, NT_distr_lj_var_w_mass_branches};
+	static double bins_lj_var_t_mass[] = {20,100,130,160,180,200,300,400};  r = {(sizeof(bins_lj_var_t_mass) / sizeof(bins_lj_var_t_mass[0]))-1, false,-1,  -1, bins_lj_var_t_mass};   m["lj_var_t_mass"] = {NT_distr_lj_var_t_mass, r, NT_distr_lj_var_t_mass_branches};
 
 	//r = {14, false,-1,  -1, .custom_bins=(double[]){0,16,32,44,54,64,74,81,88,95,104,116,132,160,250}}; m["Mt_lep_met_c"]   = {Mt_lep_met,     r};
 	//r = {2, false,-1,  -1, .custom_bins=(double[]){{0},{16},{32}}}; m["Mt_lep_met_c"]   = {Mt_lep_met,     r};
@@ -555,15 +607,15 @@ T_known_defs_distrs create_known_defs_distrs_stage2()
 	// -- ok, this works
 	//r = {2, false,-1,  -1, (static double*){0.,16.,32.}}; m["Mt_lep_met_c"]   = {Mt_lep_met,     r};
 	//static double Mt_lep_met_c_bins[] = {0,16,32,44,54,64}; r = {5, false,-1,  -1, Mt_lep_met_c_bins}; m["Mt_lep_met_c"]   = {Mt_lep_met,     r};
-	static double bins_Mt_lep_met_c[] = {0,16,32,44,54,64,74,81,88,95,104,116,132,160,250}; r = {(sizeof(bins_Mt_lep_met_c) / sizeof(bins_Mt_lep_met_c[0]))-1, false,-1,  -1, bins_Mt_lep_met_c}; m["Mt_lep_met_c"]   = {NT_distr_Mt_lep_met,     r};
+	static double bins_Mt_lep_met_c[] = {0,16,32,44,54,64,74,81,88,95,104,116,132,160,250}; r = {(sizeof(bins_Mt_lep_met_c) / sizeof(bins_Mt_lep_met_c[0]))-1, false,-1,  -1, bins_Mt_lep_met_c}; m["Mt_lep_met_c"]   = {NT_distr_Mt_lep_met,     r, NT_distr_Mt_lep_met_branches, NT_distr_Mt_lep_met_per_sys};
 	// ok! this needs a wrapper-macro
 	//cerr_expr(r.custom_bins[0]);
 	//cerr_expr(r.custom_bins[1]);
 
-	r = {20, true,  0, 250};   m["Mt_lep_met_f"]   = {NT_distr_Mt_lep_met,     r};
-	r = {25, true,  0, 200};   m["met_f2"]         = {NT_distr_met, r};
-	r = {30, true,  0, 300};   m["met_f"]          = {NT_distr_met, r};
-	static double bins_met_c[] = {0,20,40,60,80,100,120,140,200,500}; r = {(sizeof(bins_met_c) / sizeof(bins_met_c[0]))-1, false,  -1, -1, bins_met_c};   m["met_c"]  = {NT_distr_met, r};
+	r = {20, true,  0, 250};   m["Mt_lep_met_f"]   = {NT_distr_Mt_lep_met,     r, NT_distr_Mt_lep_met_branches, NT_distr_Mt_lep_met_per_sys};
+	r = {25, true,  0, 200};   m["met_f2"]         = {NT_distr_met, r, NT_distr_met_branches, NT_distr_met_per_sys};
+	r = {30, true,  0, 300};   m["met_f"]          = {NT_distr_met, r, NT_distr_met_branches, NT_distr_met_per_sys};
+	static double bins_met_c[] = {0,20,40,60,80,100,120,140,200,500}; r = {(sizeof(bins_met_c) / sizeof(bins_met_c[0]))-1, false,  -1, -1, bins_met_c};   m["met_c"]  = {NT_distr_met, r, NT_distr_met_branches, NT_distr_met_per_sys};
 
 	return m;
 }
@@ -584,110 +636,177 @@ old std_defs.py:
 'tt_elmu_tight':  (lambda sel_stage, ev: (sel_stage == 205 and ev.event_leptons[0].pt() > 30. and ev.event_leptons[1].pt() > 30.), {'NOMINAL': lambda ev: ev.selection_stage_em}),
  */
 
+/* The channels defined by the selection stages are dispatched with a table.
+ * For an object systematic, each selection-stage variable is read once,
+ * and the table of the variable gives the set of channels passing at its value.
+ * The channels with additional requirements check them on top of their bit.
+ */
+
+enum Stage2SelStageVar {SEL_STAGE_TT, SEL_STAGE_EM, SEL_STAGE_DY, SEL_STAGE_DY_ELMU, SEL_STAGE_DY_MUMU, SEL_STAGE_PRESEL, N_SEL_STAGE_VARS};
+
+enum Stage2Channel {
+	STAGE2_CHAN_mu_sel, STAGE2_CHAN_mu_sel_ss, STAGE2_CHAN_el_sel, STAGE2_CHAN_el_sel_ss, STAGE2_CHAN_lep_sel, STAGE2_CHAN_lep_sel_ss,
+	STAGE2_CHAN_el_old_presel, STAGE2_CHAN_el_old_presel_ss, STAGE2_CHAN_mu_old_presel, STAGE2_CHAN_mu_old_presel_ss,
+	STAGE2_CHAN_tt_elmu, STAGE2_CHAN_tt_elmu_tight,
+	STAGE2_CHAN_dy_mutau, STAGE2_CHAN_dy_eltau, STAGE2_CHAN_dy_mutau_ss, STAGE2_CHAN_dy_eltau_ss,
+	STAGE2_CHAN_dy_elmu, STAGE2_CHAN_dy_elmu_ss, STAGE2_CHAN_dy_mumu, STAGE2_CHAN_dy_elel,
+	N_STAGE2_CHANNELS};
+
+/** \brief The selection stages are below 256, the other values pass no channel. */
+#define N_SEL_STAGE_VALUES 256
+
+typedef bitset<N_STAGE2_CHANNELS> T_stage2_channels;
+
+/** \brief A channel passes if its selection-stage variable equals one of the stages. */
+
+typedef struct {
+	Stage2Channel     chan;
+	Stage2SelStageVar sel_stage_var;
+	vector<int>       stages;
+} _S_stage2_channel_stages;
+
+static vector<_S_stage2_channel_stages> stage2_channel_stages = {
+	{STAGE2_CHAN_mu_sel,    SEL_STAGE_TT, {9, 7}},
+	{STAGE2_CHAN_mu_sel_ss, SEL_STAGE_TT, {8, 6}},
+	{STAGE2_CHAN_el_sel,    SEL_STAGE_TT, {19, 17}},
+	{STAGE2_CHAN_el_sel_ss, SEL_STAGE_TT, {18, 16}},
+	// union of mu_sel and el_sel
+	{STAGE2_CHAN_lep_sel,    SEL_STAGE_TT, {9, 7, 19, 17}},
+	{STAGE2_CHAN_lep_sel_ss, SEL_STAGE_TT, {8, 6, 18, 16}},
+
+	// old stage2 presel!! from xsec measurement
+	{STAGE2_CHAN_el_old_presel,    SEL_STAGE_PRESEL, {19, 17}},
+	{STAGE2_CHAN_el_old_presel_ss, SEL_STAGE_PRESEL, {18, 16}},
+	{STAGE2_CHAN_mu_old_presel,    SEL_STAGE_PRESEL, {9, 7}},
+	{STAGE2_CHAN_mu_old_presel_ss, SEL_STAGE_PRESEL, {8, 6}},
+
+	{STAGE2_CHAN_tt_elmu,       SEL_STAGE_EM, {211, 212, 213, 214, 215, 216, 217, 218, 219}},
+	{STAGE2_CHAN_tt_elmu_tight, SEL_STAGE_EM, {215}},
+
+	// the dy tau channels also require mT < 40
+	{STAGE2_CHAN_dy_mutau,    SEL_STAGE_DY, {135, 134, 125, 124}},
+	{STAGE2_CHAN_dy_eltau,    SEL_STAGE_DY, {235, 234, 225, 224}},
+	{STAGE2_CHAN_dy_mutau_ss, SEL_STAGE_DY, {133, 132, 123, 122}},
+	{STAGE2_CHAN_dy_eltau_ss, SEL_STAGE_DY, {233, 232, 223, 222}},
+
+	{STAGE2_CHAN_dy_elmu,    SEL_STAGE_DY_ELMU, {105}},
+	{STAGE2_CHAN_dy_elmu_ss, SEL_STAGE_DY_ELMU, {103}},
+
+	{STAGE2_CHAN_dy_mumu, SEL_STAGE_DY_MUMU, {102, 103, 105}},
+	{STAGE2_CHAN_dy_elel, SEL_STAGE_DY_MUMU, {112, 113, 115}},
+	};
+
+/** \brief Create the tables `[selection-stage variable][stage value] -> channels` from the definitions of the channels.
+
+\return vector<vector<T_stage2_channels>>
+ */
+
+static vector<vector<T_stage2_channels>> create_stage2_channels_per_stage(void)
+	{
+	vector<vector<T_stage2_channels>> channels_per_stage(N_SEL_STAGE_VARS, vector<T_stage2_channels>(N_SEL_STAGE_VALUES));
+	for (const auto& chan_stages: stage2_channel_stages)
+		for (int stage: chan_stages.stages)
+			channels_per_stage[chan_stages.sel_stage_var][stage].set(chan_stages.chan);
+	return channels_per_stage;
+	}
+
+static vector<vector<T_stage2_channels>> stage2_channels_per_stage = create_stage2_channels_per_stage();
+
+/** \brief All channels passing the selection stages in the given object systematic.
+
+The variables are indexed with the `ObjSystematics`,
+a selection stage without a variant for an object systematic uses the NOMINAL variable.
+The table reads all selection-stage variables:
+if some of them are not active in the input, their stale values can only set the bits of the channels that are not requested.
+ */
+
+static T_stage2_channels _NT_calc_stage2_channels(ObjSystematics sys)
+	{
+	// the addresses of the thread_local buffers of this thread
+	static thread_local Int_t* const sel_stage_vars[N_SEL_STAGE_VARS][N_OBJ_SYSTEMATICS] = {
+		/* NOMINAL                      JERUp                               JERDown                               JESUp                               JESDown                               TESUp                          TESDown */
+		{&NT_selection_stage,         &NT_selection_stage_JERUp,         &NT_selection_stage_JERDown,         &NT_selection_stage_JESUp,         &NT_selection_stage_JESDown,         &NT_selection_stage_TESUp,    &NT_selection_stage_TESDown},
+		{&NT_selection_stage_em,      &NT_selection_stage_em_JERUp,      &NT_selection_stage_em_JERDown,      &NT_selection_stage_em_JESUp,      &NT_selection_stage_em_JESDown,      &NT_selection_stage_em,       &NT_selection_stage_em},
+		{&NT_selection_stage_dy,      &NT_selection_stage_dy_JERUp,      &NT_selection_stage_dy_JERDown,      &NT_selection_stage_dy_JESUp,      &NT_selection_stage_dy_JESDown,      &NT_selection_stage_dy_TESUp, &NT_selection_stage_dy_TESDown},
+		{&NT_selection_stage_dy_elmu, &NT_selection_stage_dy_elmu_JERUp, &NT_selection_stage_dy_elmu_JERDown, &NT_selection_stage_dy_elmu_JESUp, &NT_selection_stage_dy_elmu_JESDown, &NT_selection_stage_dy_elmu,  &NT_selection_stage_dy_elmu},
+		{&NT_selection_stage_dy_mumu, &NT_selection_stage_dy_mumu_JERUp, &NT_selection_stage_dy_mumu_JERDown, &NT_selection_stage_dy_mumu_JESUp, &NT_selection_stage_dy_mumu_JESDown, &NT_selection_stage_dy_mumu,  &NT_selection_stage_dy_mumu},
+		{&NT_selection_stage_presel,  &NT_selection_stage_presel,        &NT_selection_stage_presel,          &NT_selection_stage_presel,        &NT_selection_stage_presel,          &NT_selection_stage_presel,   &NT_selection_stage_presel},
+		};
+
+	T_stage2_channels passed;
+	for (int var=0; var<N_SEL_STAGE_VARS; var++)
+		{
+		Int_t stage = *sel_stage_vars[var][sys];
+		if (stage >= 0 && stage < N_SEL_STAGE_VALUES)
+			passed |= stage2_channels_per_stage[var][stage];
+		}
+	return passed;
+	}
+
+NT_calc_memoized(T_stage2_channels, NT_calc_stage2_channels)
+
 static bool NT_channel_mu_sel(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage;
-	else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_JERUp  ;
-	else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_JERDown;
-	else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_JESUp  ;
-	else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_JESDown;
-	else if (sys == TESUp)     relevant_selection_stage = NT_selection_stage_TESUp  ;
-	else if (sys == TESDown)   relevant_selection_stage = NT_selection_stage_TESDown;
-	else relevant_selection_stage = NT_selection_stage;
-	return relevant_selection_stage == 9 || relevant_selection_stage == 7;
+	return NT_calc_stage2_channels(sys)[STAGE2_CHAN_mu_sel];
 	}
+static T_branches NT_channel_mu_sel_branches = {"selection_stage", "selection_stage%s"};
 
 static bool NT_channel_mu_sel_ss(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage;
-	else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_JERUp  ;
-	else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_JERDown;
-	else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_JESUp  ;
-	else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_JESDown;
-	else if (sys == TESUp)     relevant_selection_stage = NT_selection_stage_TESUp  ;
-	else if (sys == TESDown)   relevant_selection_stage = NT_selection_stage_TESDown;
-	else relevant_selection_stage = NT_selection_stage;
-	return relevant_selection_stage == 8 || relevant_selection_stage == 6;
+	return NT_calc_stage2_channels(sys)[STAGE2_CHAN_mu_sel_ss];
 	}
+static T_branches NT_channel_mu_sel_ss_branches = {"selection_stage", "selection_stage%s"};
 
 static bool NT_channel_mu_sel_tauSV3(ObjSystematics sys)
 	{
 	bool sel = NT_channel_mu_sel(sys);
 	return sel ?  NT_event_taus_sv_sign[0] > 3. : false;
 	}
+static T_branches NT_channel_mu_sel_tauSV3_branches = branches_join({NT_channel_mu_sel_branches, {"event_taus_sv_sign"}});
 
 static bool NT_channel_mu_sel_ss_tauSV3(ObjSystematics sys)
 	{
 	bool sel = NT_channel_mu_sel_ss(sys);
 	return sel ?  NT_event_taus_sv_sign[0] > 3. : false;
 	}
+static T_branches NT_channel_mu_sel_ss_tauSV3_branches = branches_join({NT_channel_mu_sel_ss_branches, {"event_taus_sv_sign"}});
 
 static bool NT_channel_el_sel(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage;
-	else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_JERUp  ;
-	else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_JERDown;
-	else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_JESUp  ;
-	else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_JESDown;
-	else if (sys == TESUp)     relevant_selection_stage = NT_selection_stage_TESUp  ;
-	else if (sys == TESDown)   relevant_selection_stage = NT_selection_stage_TESDown;
-	else relevant_selection_stage = NT_selection_stage;
-	return relevant_selection_stage == 19 || relevant_selection_stage == 17;
+	return NT_calc_stage2_channels(sys)[STAGE2_CHAN_el_sel];
 	}
+static T_branches NT_channel_el_sel_branches = {"selection_stage", "selection_stage%s"};
 
 static bool NT_channel_el_sel_ss(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage;
-	else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_JERUp  ;
-	else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_JERDown;
-	else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_JESUp  ;
-	else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_JESDown;
-	else if (sys == TESUp)     relevant_selection_stage = NT_selection_stage_TESUp  ;
-	else if (sys == TESDown)   relevant_selection_stage = NT_selection_stage_TESDown;
-	else relevant_selection_stage = NT_selection_stage;
-	return relevant_selection_stage == 18 || relevant_selection_stage == 16;
+	return NT_calc_stage2_channels(sys)[STAGE2_CHAN_el_sel_ss];
 	}
+static T_branches NT_channel_el_sel_ss_branches = {"selection_stage", "selection_stage%s"};
 
 // old stage2 presel!! from xsec measurement
 static bool NT_channel_el_old_presel(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	//if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage;
-	//else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_JERUp  ;
-	//else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_JERDown;
-	//else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_JESUp  ;
-	//else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_JESDown;
-	//else if (sys == TESUp)     relevant_selection_stage = NT_selection_stage_TESUp  ;
-	//else if (sys == TESDown)   relevant_selection_stage = NT_selection_stage_TESDown;
-	relevant_selection_stage = NT_selection_stage_presel;
-	return (relevant_selection_stage == 19 || relevant_selection_stage == 17);
+	return NT_calc_stage2_channels(sys)[STAGE2_CHAN_el_old_presel];
 	}
+static T_branches NT_channel_el_old_presel_branches = {"selection_stage_presel"};
 
 static bool NT_channel_el_old_presel_ss(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	relevant_selection_stage = NT_selection_stage_presel;
-	return (relevant_selection_stage == 18 || relevant_selection_stage == 16); // || relevant_selection_stage == 15);
+	return NT_calc_stage2_channels(sys)[STAGE2_CHAN_el_old_presel_ss];
 	}
+static T_branches NT_channel_el_old_presel_ss_branches = {"selection_stage_presel"};
 
 static bool NT_channel_mu_old_presel(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	relevant_selection_stage = NT_selection_stage_presel;
-	//return relevant_selection_stage == 9;
-	return (relevant_selection_stage == 9 || relevant_selection_stage == 7);
+	return NT_calc_stage2_channels(sys)[STAGE2_CHAN_mu_old_presel];
 	}
+static T_branches NT_channel_mu_old_presel_branches = {"selection_stage_presel"};
 
 static bool NT_channel_mu_old_presel_ss(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	relevant_selection_stage = NT_selection_stage_presel;
-	return (relevant_selection_stage == 8 || relevant_selection_stage == 6);
+	return NT_calc_stage2_channels(sys)[STAGE2_CHAN_mu_old_presel_ss];
 	}
+static T_branches NT_channel_mu_old_presel_ss_branches = {"selection_stage_presel"};
 
 
 static bool NT_channel_el_sel_tauSV3(ObjSystematics sys)
@@ -695,47 +814,34 @@ static bool NT_channel_el_sel_tauSV3(ObjSystematics sys)
 	bool sel = NT_channel_el_sel(sys);
 	return sel ?  NT_event_taus_sv_sign[0] > 3. : false;
 	}
+static T_branches NT_channel_el_sel_tauSV3_branches = branches_join({NT_channel_el_sel_branches, {"event_taus_sv_sign"}});
 
 static bool NT_channel_el_sel_ss_tauSV3(ObjSystematics sys)
 	{
 	bool sel = NT_channel_el_sel_ss(sys);
 	return sel ?  NT_event_taus_sv_sign[0] > 3. : false;
 	}
+static T_branches NT_channel_el_sel_ss_tauSV3_branches = branches_join({NT_channel_el_sel_ss_branches, {"event_taus_sv_sign"}});
 
 // union os mu_sel and el_sel
 static bool NT_channel_lep_sel(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage;
-	else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_JERUp  ;
-	else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_JERDown;
-	else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_JESUp  ;
-	else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_JESDown;
-	else if (sys == TESUp)     relevant_selection_stage = NT_selection_stage_TESUp  ;
-	else if (sys == TESDown)   relevant_selection_stage = NT_selection_stage_TESDown;
-	else relevant_selection_stage = NT_selection_stage;
-	return relevant_selection_stage == 9 || relevant_selection_stage == 7 || relevant_selection_stage == 19 || relevant_selection_stage == 17;
+	return NT_calc_stage2_channels(sys)[STAGE2_CHAN_lep_sel];
 	}
+static T_branches NT_channel_lep_sel_branches = {"selection_stage", "selection_stage%s"};
 
 static bool NT_channel_lep_sel_ss(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage;
-	else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_JERUp  ;
-	else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_JERDown;
-	else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_JESUp  ;
-	else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_JESDown;
-	else if (sys == TESUp)     relevant_selection_stage = NT_selection_stage_TESUp  ;
-	else if (sys == TESDown)   relevant_selection_stage = NT_selection_stage_TESDown;
-	else relevant_selection_stage = NT_selection_stage;
-	return relevant_selection_stage == 8 || relevant_selection_stage == 6 || relevant_selection_stage == 18 || relevant_selection_stage == 16;
+	return NT_calc_stage2_channels(sys)[STAGE2_CHAN_lep_sel_ss];
 	}
+static T_branches NT_channel_lep_sel_ss_branches = {"selection_stage", "selection_stage%s"};
 
 static bool NT_channel_lep_sel_tauSV3(ObjSystematics sys)
 	{
 	bool sel = NT_channel_lep_sel(sys);
 	return sel ?  NT_event_taus_sv_sign[0] > 3. : false;
 	}
+static T_branches NT_channel_lep_sel_tauSV3_branches = branches_join({NT_channel_lep_sel_branches, {"event_taus_sv_sign"}});
 
 static bool NT_channel_lep_sel_ss_tauSV3(ObjSystematics sys)
 	{
@@ -744,101 +850,62 @@ static bool NT_channel_lep_sel_ss_tauSV3(ObjSystematics sys)
 	//return sel && NT_event_taus_sv_sign[0] > 3.;
 	return sel ?  NT_event_taus_sv_sign[0] > 3. : false;
 	}
+static T_branches NT_channel_lep_sel_ss_tauSV3_branches = branches_join({NT_channel_lep_sel_ss_branches, {"event_taus_sv_sign"}});
 
 
 static bool NT_channel_tt_elmu(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage_em;
-	else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_em_JERUp  ;
-	else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_em_JERDown;
-	else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_em_JESUp  ;
-	else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_em_JESDown;
-	else relevant_selection_stage = NT_selection_stage_em;
-	return relevant_selection_stage > 210 && relevant_selection_stage < 220;
+	return NT_calc_stage2_channels(sys)[STAGE2_CHAN_tt_elmu];
 	}
+static T_branches NT_channel_tt_elmu_branches = {"selection_stage_em", "selection_stage_em%s"};
 
 static bool NT_channel_tt_elmu_tight(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage_em;
-	else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_em_JERUp  ;
-	else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_em_JERDown;
-	else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_em_JESUp  ;
-	else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_em_JESDown;
-	else relevant_selection_stage = NT_selection_stage_em;
-	return relevant_selection_stage == 215;
+	return NT_calc_stage2_channels(sys)[STAGE2_CHAN_tt_elmu_tight];
 	}
+static T_branches NT_channel_tt_elmu_tight_branches = {"selection_stage_em", "selection_stage_em%s"};
 
 
 
 static bool NT_channel_dy_mutau(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage_dy;
-	else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_dy_JERUp  ;
-	else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_dy_JERDown;
-	else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_dy_JESUp  ;
-	else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_dy_JESDown;
-	else if (sys == TESUp)     relevant_selection_stage = NT_selection_stage_dy_TESUp  ;
-	else if (sys == TESDown)   relevant_selection_stage = NT_selection_stage_dy_TESDown;
-	else relevant_selection_stage = NT_selection_stage_dy;
+	if (!NT_calc_stage2_channels(sys)[STAGE2_CHAN_dy_mutau]) return false;
 
 	double mT = NT_distr_Mt_lep_met(sys);
 
-	return mT < 40 && (relevant_selection_stage == 135 || relevant_selection_stage == 134 || relevant_selection_stage == 125 || relevant_selection_stage == 124);
+	return mT < 40;
 	}
+static T_branches NT_channel_dy_mutau_branches = branches_join({{"selection_stage_dy", "selection_stage_dy%s"}, NT_distr_Mt_lep_met_branches});
 
 static bool NT_channel_dy_eltau(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage_dy;
-	else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_dy_JERUp  ;
-	else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_dy_JERDown;
-	else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_dy_JESUp  ;
-	else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_dy_JESDown;
-	else if (sys == TESUp)     relevant_selection_stage = NT_selection_stage_dy_TESUp  ;
-	else if (sys == TESDown)   relevant_selection_stage = NT_selection_stage_dy_TESDown;
-	else relevant_selection_stage = NT_selection_stage_dy;
+	if (!NT_calc_stage2_channels(sys)[STAGE2_CHAN_dy_eltau]) return false;
 
 	double mT = NT_distr_Mt_lep_met(sys);
 
-	return mT < 40 && (relevant_selection_stage == 235 || relevant_selection_stage == 234 || relevant_selection_stage == 225 || relevant_selection_stage == 224);
+	return mT < 40;
 	}
+static T_branches NT_channel_dy_eltau_branches = branches_join({{"selection_stage_dy", "selection_stage_dy%s"}, NT_distr_Mt_lep_met_branches});
 
 static bool NT_channel_dy_mutau_ss(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage_dy;
-	else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_dy_JERUp  ;
-	else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_dy_JERDown;
-	else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_dy_JESUp  ;
-	else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_dy_JESDown;
-	else if (sys == TESUp)     relevant_selection_stage = NT_selection_stage_dy_TESUp  ;
-	else if (sys == TESDown)   relevant_selection_stage = NT_selection_stage_dy_TESDown;
-	else relevant_selection_stage = NT_selection_stage_dy;
+	if (!NT_calc_stage2_channels(sys)[STAGE2_CHAN_dy_mutau_ss]) return false;
 
 	double mT = NT_distr_Mt_lep_met(sys);
 
-	return mT < 40 && (relevant_selection_stage == 133 || relevant_selection_stage == 132 || relevant_selection_stage == 123 || relevant_selection_stage == 122);
+	return mT < 40;
 	}
+static T_branches NT_channel_dy_mutau_ss_branches = branches_join({{"selection_stage_dy", "selection_stage_dy%s"}, NT_distr_Mt_lep_met_branches});
 
 static bool NT_channel_dy_eltau_ss(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage_dy;
-	else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_dy_JERUp  ;
-	else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_dy_JERDown;
-	else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_dy_JESUp  ;
-	else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_dy_JESDown;
-	else if (sys == TESUp)     relevant_selection_stage = NT_selection_stage_dy_TESUp  ;
-	else if (sys == TESDown)   relevant_selection_stage = NT_selection_stage_dy_TESDown;
-	else relevant_selection_stage = NT_selection_stage_dy;
+	if (!NT_calc_stage2_channels(sys)[STAGE2_CHAN_dy_eltau_ss]) return false;
 
 	double mT = NT_distr_Mt_lep_met(sys);
 
-	return mT < 40 && (relevant_selection_stage == 233 || relevant_selection_stage == 232 || relevant_selection_stage == 223 || relevant_selection_stage == 222);
+	return mT < 40;
 	}
+static T_branches NT_channel_dy_eltau_ss_branches = branches_join({{"selection_stage_dy", "selection_stage_dy%s"}, NT_distr_Mt_lep_met_branches});
 
 static bool NT_channel_dy_mutau_tauSV3(ObjSystematics sys)
 	{
@@ -846,77 +913,57 @@ static bool NT_channel_dy_mutau_tauSV3(ObjSystematics sys)
 	// I use the if expression to be sure the vector NT_event_taus_sv_sign is not empty!
 	return sel ?  NT_event_taus_sv_sign[0] > 3. : false;
 	}
+static T_branches NT_channel_dy_mutau_tauSV3_branches = branches_join({NT_channel_dy_mutau_branches, {"event_taus_sv_sign"}});
 static bool NT_channel_dy_mutau_ss_tauSV3(ObjSystematics sys)
 	{
 	bool sel = NT_channel_dy_mutau_ss(sys);
 	return sel ?  NT_event_taus_sv_sign[0] > 3. : false;
 	}
+static T_branches NT_channel_dy_mutau_ss_tauSV3_branches = branches_join({NT_channel_dy_mutau_ss_branches, {"event_taus_sv_sign"}});
 
 static bool NT_channel_dy_eltau_tauSV3(ObjSystematics sys)
 	{
 	bool sel = NT_channel_dy_eltau(sys);
 	return sel ?  NT_event_taus_sv_sign[0] > 3. : false;
 	}
+static T_branches NT_channel_dy_eltau_tauSV3_branches = branches_join({NT_channel_dy_eltau_branches, {"event_taus_sv_sign"}});
 static bool NT_channel_dy_eltau_ss_tauSV3(ObjSystematics sys)
 	{
 	bool sel = NT_channel_dy_eltau_ss(sys);
 	return sel ?  NT_event_taus_sv_sign[0] > 3. : false;
 	}
+static T_branches NT_channel_dy_eltau_ss_tauSV3_branches = branches_join({NT_channel_dy_eltau_ss_branches, {"event_taus_sv_sign"}});
 
 
 
 static bool NT_channel_dy_elmu(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage_dy_elmu;
-	else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_dy_elmu_JERUp  ;
-	else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_dy_elmu_JERDown;
-	else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_dy_elmu_JESUp  ;
-	else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_dy_elmu_JESDown;
-	else relevant_selection_stage = NT_selection_stage_dy_elmu;
-	return relevant_selection_stage == 105;
+	return NT_calc_stage2_channels(sys)[STAGE2_CHAN_dy_elmu];
 	}
+static T_branches NT_channel_dy_elmu_branches = {"selection_stage_dy_elmu", "selection_stage_dy_elmu%s"};
 
 static bool NT_channel_dy_elmu_ss(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage_dy_elmu;
-	else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_dy_elmu_JERUp  ;
-	else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_dy_elmu_JERDown;
-	else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_dy_elmu_JESUp  ;
-	else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_dy_elmu_JESDown;
-	else relevant_selection_stage = NT_selection_stage_dy_elmu;
-	return relevant_selection_stage == 103;
+	return NT_calc_stage2_channels(sys)[STAGE2_CHAN_dy_elmu_ss];
 	}
+static T_branches NT_channel_dy_elmu_ss_branches = {"selection_stage_dy_elmu", "selection_stage_dy_elmu%s"};
 
 
 static bool NT_channel_dy_mumu(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage_dy_mumu;
-	else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_dy_mumu_JERUp  ;
-	else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_dy_mumu_JERDown;
-	else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_dy_mumu_JESUp  ;
-	else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_dy_mumu_JESDown;
-	else relevant_selection_stage = NT_selection_stage_dy_mumu;
-	return relevant_selection_stage == 102 || relevant_selection_stage == 103 || relevant_selection_stage == 105;
+	return NT_calc_stage2_channels(sys)[STAGE2_CHAN_dy_mumu];
 	}
+static T_branches NT_channel_dy_mumu_branches = {"selection_stage_dy_mumu", "selection_stage_dy_mumu%s"};
 
 static bool NT_channel_dy_elel(ObjSystematics sys)
 	{
-	int relevant_selection_stage = 0;
-	if      (sys == NOMINAL)   relevant_selection_stage = NT_selection_stage_dy_mumu;
-	else if (sys == JERUp)     relevant_selection_stage = NT_selection_stage_dy_mumu_JERUp  ;
-	else if (sys == JERDown)   relevant_selection_stage = NT_selection_stage_dy_mumu_JERDown;
-	else if (sys == JESUp)     relevant_selection_stage = NT_selection_stage_dy_mumu_JESUp  ;
-	else if (sys == JESDown)   relevant_selection_stage = NT_selection_stage_dy_mumu_JESDown;
-	else relevant_selection_stage = NT_selection_stage_dy_mumu;
-	return relevant_selection_stage == 112 || relevant_selection_stage == 113 || relevant_selection_stage == 115;
+	return NT_calc_stage2_channels(sys)[STAGE2_CHAN_dy_elel];
 	}
+static T_branches NT_channel_dy_elel_branches = {"selection_stage_dy_mumu", "selection_stage_dy_mumu%s"};
 
 
 
-#define _quick_set_chandef(m, chan_name, sel_weight_func) m[#chan_name] = {NT_channel_ ## chan_name, sel_weight_func}
+#define _quick_set_chandef(m, chan_name, sel_weight_func) m[#chan_name] = {NT_channel_ ## chan_name, sel_weight_func, branches_join({NT_channel_ ## chan_name ## _branches, sel_weight_func ## _branches})}
 
 /** \brief The initialization function for the `bool` functions of the known distributions in the stage2 output ntuples.
 
@@ -1011,6 +1058,14 @@ static bool NT_genproc_inclusive()
 	return true;
 	}
 
+/** \brief the gen process ID is calculated in stage2
+*/
+
+static int NT_calc_gen_proc_id()
+	{
+	return NT_gen_proc_id;
+	}
+
 static bool NT_genproc_tt_eltau3ch()
 	{
 	return NT_gen_proc_id == 42;
@@ -1170,7 +1225,9 @@ T_known_defs_procs create_known_defs_procs_stage2()
 			{"dy_mumu",       _mumu_tt_procs},
 			{"dy_elel",       _mumu_tt_procs},
 
-			}
+			},
+		.branches = {"gen_proc_id"},
+		.gen_proc_id = NT_calc_gen_proc_id,
 		};
 
 	m["dy"] = {
@@ -1213,7 +1270,9 @@ T_known_defs_procs create_known_defs_procs_stage2()
 			{"dy_elel",       _incl_dy_procs},
 			{"dy_elmu",       _leptau_dy_procs},
 			{"dy_elmu_ss",    _leptau_dy_procs},
-			}
+			},
+		.branches = {"gen_proc_id"},
+		.gen_proc_id = NT_calc_gen_proc_id,
 		};
 
 	m["stop"] = {
@@ -1259,7 +1318,9 @@ T_known_defs_procs create_known_defs_procs_stage2()
 			{"dy_elel",        _mumu_stop_procs},
 			{"dy_elmu",       _elmu_stop_procs},
 			{"dy_elmu_ss",    _elmu_stop_procs},
-			}
+			},
+		.branches = {"gen_proc_id"},
+		.gen_proc_id = NT_calc_gen_proc_id,
 		};
 
 	m["wjets"] = {
@@ -1303,7 +1364,9 @@ T_known_defs_procs create_known_defs_procs_stage2()
 			{"dy_elel",        _mumu_wjets_procs},
 			{"dy_elmu",       _elmu_wjets_procs},
 			{"dy_elmu_ss",    _elmu_wjets_procs},
-			}
+			},
+		.branches = {"gen_proc_id"},
+		.gen_proc_id = NT_calc_gen_proc_id,
 		};
 
 	m["qcd"] = {
@@ -1343,7 +1406,8 @@ T_known_defs_procs create_known_defs_procs_stage2()
 			{"dy_elel",       _any_procs},
 			{"dy_elmu",       _any_procs},
 			{"dy_elmu_ss",    _any_procs},
-			}
+			},
+		.branches = {},
 		};
 
 
@@ -1383,7 +1447,8 @@ T_known_defs_procs create_known_defs_procs_stage2()
 			{"dy_elel",       {}},
 			{"dy_elmu",       {}},
 			{"dy_elmu_ss",    {}},
-			}
+			},
+		.branches = {},
 		};
 
 
@@ -1633,6 +1698,10 @@ int connect_ntuple_interface_stage2(TTree* NT_output_ttree)
 	#define NTUPLE_INTERFACE_CONNECT
 	#include "stage2_interface.h" // it runs a bunch of branch-connecting commands on TTree* with name OUTNTUPLE
 
+	// invalidate the memoized NT_calc_* results of the previously connected ttree
+	NT_memo_ttree = NT_output_ttree;
+	NT_memo_generation++;
+
 	return 0;
 	}
 
@@ -0,0 +1,57 @@
+
+#include "UserCode/proc/interface/sumup_loop_ntuple.h"
+
+#include <ctype.h>
+#include <string.h>
+
+/** \brief Concatenate lists of branches, e.g. the branches of a channel and of its weight.
+
+The duplicates are kept, `sumup_loop` makes the union.
+
+\return T_branches
+ */
+
+T_branches branches_join(std::initializer_list<T_branches> lists)
+	{
+	T_branches joined;
+	for (const auto& list: lists)
+		joined.insert(joined.end(), list.begin(), list.end());
+	return joined;
+	}
+
+/** \brief Find the branches in the source text of an expression.
+
+The macro-defined definitions, like `NT_sysweight(PUUp, NT_event_weight_PUUp / NT_event_weight_PU)`,
+pass their stringified expression here.
+Following the protocol of the ntuple interface, the variable `NT_Name` is the branch `Name`.
+The calls of other `NT_` functions are not followed, such expressions must declare their branches explicitly.
+
+\return T_branches
+ */
+
+T_branches branches_in_expression(const char* expression)
+	{
+	T_branches branches;
+
+	for (const char* c = expression; *c; c++)
+		{
+		// an identifier starting with NT_
+		bool starts_identifier = c == expression || !(isalnum(*(c-1)) || *(c-1) == '_');
+		if (!starts_identifier || strncmp(c, "NT_", 3) != 0) continue;
+
+		const char* name_start = c + 3;
+		const char* name_end   = name_start;
+		while (isalnum(*name_end) || *name_end == '_') name_end++;
+
+		// skip function calls
+		const char* next = name_end;
+		while (*next == ' ' || *next == '\t') next++;
+		if (*next != '(' && name_end > name_start)
+			branches.push_back(TString(name_start, name_end - name_start));
+
+		c = name_end - 1;
+		}
+
+	return branches;
+	}
+
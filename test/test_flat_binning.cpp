@@ -0,0 +1,85 @@
+/** checking the bin lookup of the flat histograms against TAxis::FindFixBin
+in the ranges of all distributions of the stage2 and the ntupler interfaces
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <limits>
+
+#include "TH1D.h"
+
+#include "UserCode/proc/interface/flat_histo.h"
+#include "UserCode/proc/interface/ntuple_stage2.h"
+#include "UserCode/proc/interface/ntuple_ntupler.h"
+
+#include "UserCode/proc/interface/handy_macros.h"
+
+/** \brief Compare `flat_binning_find_bin` with `TAxis::FindFixBin` at the bin edges and around them,
+at the integer values in the range, below `xmin`, at `xmax` and at NaN.
+
+\return the number of the values in different bins
+ */
+
+unsigned int check_range(const TString& name, const _TH1D_histo_range& range)
+	{
+	TH1D* histo = range.linear ?
+		new TH1D(name, name, range.nbins, range.linear_min, range.linear_max) :
+		new TH1D(name, name, range.nbins, range.custom_bins);
+	TAxis* axis = histo->GetXaxis();
+	S_flat_binning binning = create_flat_binning(histo);
+
+	double xmin = axis->GetXmin();
+	double xmax = axis->GetXmax();
+	vector<double> values = {nextafter(xmin, -INFINITY), xmax, numeric_limits<double>::quiet_NaN(), -INFINITY, INFINITY};
+
+	for (int bin=1; bin<=axis->GetNbins()+1; bin++)
+		{
+		// the edge as TAxis calculates it, and as the definitions calculate it
+		double edges[2] = {axis->GetBinLowEdge(bin), range.linear ? xmin + (bin-1) * (xmax - xmin) / range.nbins : range.custom_bins[bin-1]};
+		for (double edge: edges)
+			{
+			values.push_back(edge);
+			values.push_back(nextafter(edge, -INFINITY));
+			values.push_back(nextafter(edge,  INFINITY));
+			}
+		}
+
+	// the integer-valued distributions put their values at the edges
+	for (double x = floor(xmin); x <= ceil(xmax) && x - floor(xmin) <= 10000; x++)
+		values.push_back(x);
+
+	unsigned int n_mismatches = 0;
+	for (double value: values)
+		{
+		unsigned int bin = flat_binning_find_bin(binning, value);
+		int root_bin = axis->FindFixBin(value);
+		Stopif(bin != (unsigned int) root_bin, n_mismatches++, "%s: the value %.17g is in the bin %u, TAxis::FindFixBin gives %d", name.Data(), value, bin, root_bin);
+		}
+
+	delete histo;
+	return n_mismatches;
+	}
+
+int main (int argc, char *argv[])
+{
+TH1::AddDirectory(kFALSE);
+
+unsigned int n_ranges = 0;
+unsigned int n_mismatches = 0;
+
+for (const auto& distr: create_known_defs_distrs_stage2())
+	{
+	n_mismatches += check_range("stage2_" + distr.first, distr.second.range);
+	n_ranges++;
+	}
+
+for (const auto& distr: create_known_defs_distrs_ntupler())
+	{
+	n_mismatches += check_range("ntupler_" + distr.first, distr.second.range);
+	n_ranges++;
+	}
+
+printf("checked %u ranges, %u values in different bins\n", n_ranges, n_mismatches);
+return n_mismatches > 0;
+}
+